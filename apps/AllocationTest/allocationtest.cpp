@@ -0,0 +1,165 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Checks that converting list measurements for the application does not allocate
+ * once the lists have reached their size. Replaces the global operator new to count
+ * allocations and drives the converters used by the push sink receivers and by the
+ * list pull sinks with lists of changing length. Returns non-zero on allocations.
+ */
+
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <utMeasurement/Measurement.h>
+#include <utFacade/SimpleConverters.h>
+
+using namespace Ubitrack;
+
+namespace {
+
+/** number of allocations while \c g_bCounting is set */
+unsigned long g_nAllocations = 0;
+bool g_bCounting = false;
+
+void* allocate( std::size_t nBytes )
+{
+	if ( g_bCounting )
+		g_nAllocations++;
+	void* p = malloc( nBytes ? nBytes : 1 );
+	if ( !p )
+		throw std::bad_alloc();
+	return p;
+}
+
+} // anonymous namespace
+
+
+void* operator new( std::size_t nBytes )
+{ return allocate( nBytes ); }
+
+void* operator new[]( std::size_t nBytes )
+{ return allocate( nBytes ); }
+
+void operator delete( void* p ) throw()
+{ free( p ); }
+
+void operator delete[]( void* p ) throw()
+{ free( p ); }
+
+
+namespace {
+
+/** longest list sent, the steady state is reached once a list of this length was converted */
+const std::size_t g_nMaxLength = 32;
+
+/** conversions counted per converter */
+const std::size_t g_nConversions = 10000;
+
+/** receiver that ignores the lists, like an application that only reads them */
+class NullReceiver
+	: public Facade::SimplePosition2DListReceiver
+	, public Facade::SimplePositionList3DReceiver
+	, public Facade::SimpleErrorPositionList3DReceiver
+{
+public:
+	void receivePosition2DList( const Facade::SimplePosition2DList& ) throw()
+	{}
+
+	void receivePositionList3D( const Facade::SimplePositionList3D& ) throw()
+	{}
+
+	void receiveErrorPositionList3D( const Facade::SimpleErrorPositionList3D& ) throw()
+	{}
+};
+
+/** list measurements of all lengths up to \c g_nMaxLength, starting with the longest */
+template< class EventType >
+std::vector< EventType > makeEvents()
+{
+	std::vector< EventType > events;
+	for ( std::size_t n = g_nMaxLength + 1; n-- > 0; )
+		events.push_back( EventType( 1000 + n, typename EventType::value_type( n ) ) );
+	return events;
+}
+
+/**
+ * Converts the events over and over, first with Facade::convert as the list pull sinks do,
+ * then with SimpleConverter and dispatch as the push sinks do with their receivers.
+ * Only the conversions after the first round are counted.
+ */
+template< class EventType >
+unsigned steadyState( const std::string& sName )
+{
+	typedef Facade::SimpleConverter< EventType > Converter;
+	const std::vector< EventType > events( makeEvents< EventType >() );
+	NullReceiver receiver;
+	typename Converter::SimpleType pulled;
+	typename Converter::SimpleType pushed;
+
+	for ( std::size_t i = 0; i < events.size(); i++ )
+	{
+		Facade::convert( events[ i ], pulled );
+		Converter::convert( events[ i ], pushed );
+	}
+
+	g_nAllocations = 0;
+	g_bCounting = true;
+	for ( std::size_t i = 0; i < g_nConversions; i++ )
+		Facade::convert( events[ i % events.size() ], pulled );
+	g_bCounting = false;
+	const unsigned long nPullAllocations = g_nAllocations;
+
+	g_nAllocations = 0;
+	g_bCounting = true;
+	for ( std::size_t i = 0; i < g_nConversions; i++ )
+	{
+		Converter::convert( events[ i % events.size() ], pushed );
+		Converter::dispatch( &receiver, pushed );
+	}
+	g_bCounting = false;
+	const unsigned long nPushAllocations = g_nAllocations;
+
+	std::cout << sName << ": " << nPullAllocations << " allocations converting for pull sinks, "
+		<< nPushAllocations << " dispatching to receivers" << std::endl;
+	return nPullAllocations || nPushAllocations ? 1 : 0;
+}
+
+} // anonymous namespace
+
+
+int main( int, char** )
+{
+	unsigned nFailed = 0;
+	nFailed += steadyState< Measurement::PositionList2 >( "PositionList2" );
+	nFailed += steadyState< Measurement::PositionList >( "PositionList" );
+	nFailed += steadyState< Measurement::ErrorPositionList >( "ErrorPositionList" );
+
+	if ( nFailed )
+		std::cout << nFailed << " converters allocated in steady state" << std::endl;
+	return nFailed ? 2 : 0;
+}
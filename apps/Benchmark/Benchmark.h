@@ -0,0 +1,87 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Helpers shared by the sections of the facade benchmark.
+ */
+
+#ifndef __UBITRACK_BENCHMARK_H_INCLUDED__
+#define __UBITRACK_BENCHMARK_H_INCLUDED__
+
+#include <string>
+#include <iostream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace Ubitrack { namespace Benchmark {
+
+/** measures the time of a loop */
+class Stopwatch
+{
+public:
+	Stopwatch()
+		: m_start( boost::posix_time::microsec_clock::universal_time() )
+	{}
+
+	/** elapsed time in nanoseconds */
+	double elapsedNs() const
+	{ return ( boost::posix_time::microsec_clock::universal_time() - m_start ).total_microseconds() * 1000.0; }
+
+protected:
+	boost::posix_time::ptime m_start;
+};
+
+/** prints the cost per iteration of a timed loop */
+inline void report( const std::string& sName, const Stopwatch& watch, unsigned long nIterations )
+{
+	std::cout << "  " << sName << ": " << watch.elapsedNs() / nIterations << " ns" << std::endl;
+}
+
+/** prints a failed check, returns the number of failures */
+inline unsigned check( bool bOk, const std::string& sWhat )
+{
+	if ( bOk )
+		return 0;
+	std::cout << "  FAILED: " << sWhat << std::endl;
+	return 1;
+}
+
+/**
+ * A section of the benchmark.
+ * Runs the timed loops with \p nIterations iterations and the checks.
+ * @return number of failed checks
+ */
+typedef unsigned ( *Section )( unsigned long nIterations );
+
+/** text parser of the push sources against \c Util::SimpleStringIArchive */
+unsigned textParser( unsigned long nIterations );
+
+/** cost of Facade::Clock and its monotonicity across threads and corrections */
+unsigned facadeClock( unsigned long nIterations );
+
+/** cost per event of handing push sink events to the simple receivers */
+unsigned dispatch( unsigned long nIterations );
+
+} } // namespace Ubitrack::Benchmark
+
+#endif // __UBITRACK_BENCHMARK_H_INCLUDED__
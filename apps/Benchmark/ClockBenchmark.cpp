@@ -0,0 +1,157 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Cost and monotonicity of Facade::Clock, which timestamps the events of the push sources.
+ */
+
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <utMeasurement/Measurement.h>
+#include <utFacade/Clock.h>
+
+#include "Benchmark.h"
+
+namespace Ubitrack { namespace Benchmark {
+
+namespace {
+
+/** duration of the monotonicity check, spanning several corrections of the clock */
+const unsigned g_nMonotonicitySeconds = 3;
+
+/** largest backwards step accepted, corrections move the clock by a few ns */
+const unsigned long long g_nToleranceNs = 1000;
+
+/** result of a thread of the monotonicity check */
+struct MonotonicityResult
+{
+	MonotonicityResult()
+		: nReadings( 0 )
+		, nBackwards( 0 )
+		, nMaxBackwardsNs( 0 )
+	{}
+
+	unsigned long long nReadings;
+	unsigned long long nBackwards;
+	unsigned long long nMaxBackwardsNs;
+};
+
+/**
+ * Reads the clock until \p bStop is set. Every reading must not be earlier than the
+ * latest reading published by any thread before it, which is then replaced by it.
+ */
+void monotonicityThread( boost::atomic< unsigned long long >& latest, const boost::atomic< bool >& bStop,
+	MonotonicityResult& result )
+{
+	while ( !bStop.load( boost::memory_order_relaxed ) )
+	{
+		unsigned long long nSeen = latest.load( boost::memory_order_acquire );
+		unsigned long long t = Facade::Clock::now();
+		result.nReadings++;
+		if ( t < nSeen )
+		{
+			result.nBackwards++;
+			if ( nSeen - t > result.nMaxBackwardsNs )
+				result.nMaxBackwardsNs = nSeen - t;
+			continue;
+		}
+
+		while ( t > nSeen && !latest.compare_exchange_weak( nSeen, t, boost::memory_order_release, boost::memory_order_acquire ) )
+			;
+	}
+}
+
+unsigned checkMonotonicity()
+{
+	const unsigned nThreads = std::max( 2u, std::min( 4u, boost::thread::hardware_concurrency() ) );
+	boost::atomic< unsigned long long > latest( 0 );
+	boost::atomic< bool > bStop( false );
+	std::vector< MonotonicityResult > results( nThreads );
+	std::vector< boost::shared_ptr< boost::thread > > threads;
+	for ( unsigned i = 0; i < nThreads; i++ )
+		threads.push_back( boost::shared_ptr< boost::thread >( new boost::thread(
+			boost::bind( &monotonicityThread, boost::ref( latest ), boost::cref( bStop ), boost::ref( results[ i ] ) ) ) ) );
+
+	boost::this_thread::sleep( boost::posix_time::seconds( g_nMonotonicitySeconds ) );
+	bStop.store( true );
+
+	MonotonicityResult total;
+	for ( unsigned i = 0; i < nThreads; i++ )
+	{
+		threads[ i ]->join();
+		total.nReadings += results[ i ].nReadings;
+		total.nBackwards += results[ i ].nBackwards;
+		total.nMaxBackwardsNs = std::max( total.nMaxBackwardsNs, results[ i ].nMaxBackwardsNs );
+	}
+
+	std::cout << "  " << nThreads << " threads, " << total.nReadings << " readings in " << g_nMonotonicitySeconds
+		<< " s: " << total.nBackwards << " backwards, at most " << total.nMaxBackwardsNs << " ns" << std::endl;
+	return check( total.nMaxBackwardsNs <= g_nToleranceNs, "clock went backwards across threads by more than the tolerance" );
+}
+
+} // anonymous namespace
+
+
+unsigned facadeClock( unsigned long nIterations )
+{
+	std::cout << "  " << ( Facade::Clock::usesTsc() ? "using the time stamp counter" : "using the system clock" ) << std::endl;
+	unsigned long long nSum = 0;
+
+	Stopwatch facade;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+		nSum += Facade::Clock::now();
+	report( "Facade::Clock::now", facade, nIterations );
+
+	Stopwatch measurement;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+		nSum += Measurement::now();
+	report( "Measurement::now", measurement, nIterations );
+
+#ifdef __linux__
+	Stopwatch system;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+	{
+		struct timespec ts;
+		clock_gettime( CLOCK_REALTIME, &ts );
+		nSum += ts.tv_nsec;
+	}
+	report( "clock_gettime", system, nIterations );
+#endif
+
+	// keeps the loops from being optimized away
+	if ( nSum == 1 )
+		std::cout << nSum << std::endl;
+
+	long long nOffset = static_cast< long long >( Facade::Clock::now() - Measurement::now() );
+	std::cout << "  offset to Measurement::now: " << nOffset << " ns" << std::endl;
+
+	return checkMonotonicity();
+}
+
+} } // namespace Ubitrack::Benchmark
@@ -0,0 +1,140 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Cost per event of handing push sink events to the receivers of the simple facade,
+ * through the SimpleConverter traits the sinks use and through the boost::function
+ * wrapped conversion callbacks they replaced.
+ */
+
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <utMeasurement/Measurement.h>
+#include <utFacade/SimpleConverters.h>
+
+#include "Benchmark.h"
+
+namespace Ubitrack { namespace Benchmark {
+
+namespace {
+
+/** receiver that only counts the events */
+class CountingReceiver
+	: public Facade::SimplePoseReceiver
+	, public Facade::SimplePositionList3DReceiver
+{
+public:
+	CountingReceiver()
+		: nEvents( 0 )
+	{}
+
+	void receivePose( const Facade::SimplePose& ) throw()
+	{ nEvents++; }
+
+	void receivePositionList3D( const Facade::SimplePositionList3D& ) throw()
+	{ nEvents++; }
+
+	unsigned long nEvents;
+};
+
+/** the former pose callback of SimpleFacade, bound to the receiver */
+void poseCallback( Facade::SimplePoseReceiver* receiver, const Measurement::Pose& measurement )
+{
+	Facade::SimplePose p;
+	p.tx = measurement->translation()( 0 );
+	p.ty = measurement->translation()( 1 );
+	p.tz = measurement->translation()( 2 );
+	p.rx = measurement->rotation().x();
+	p.ry = measurement->rotation().y();
+	p.rz = measurement->rotation().z();
+	p.rw = measurement->rotation().w();
+	p.timestamp = measurement.time();
+	receiver->receivePose( p );
+}
+
+/** the former position list callback of SimpleFacade, filling a new list for every event */
+void positionListCallback( Facade::SimplePositionList3DReceiver* receiver, const Measurement::PositionList& measurement )
+{
+	Facade::SimplePositionList3D p;
+	const std::size_t count( measurement->size() );
+	for( std::size_t i( 0 ); i<count; i++ )
+	{
+		SimplePosition3DValue value;
+		Math::Vector< double, 3 > v3 = (*measurement)[i];
+		value.x = v3[0];
+		value.y = v3[1];
+		value.z = v3[2];
+		p.values.push_back(value);
+	}
+	p.timestamp = measurement.time();
+	receiver->receivePositionList3D( p );
+}
+
+/** times the old callback against the converter traits for \p e */
+template< class EventType >
+unsigned compareDispatch( const std::string& sName, const EventType& e,
+	void ( *callback )( typename Facade::SimpleConverter< EventType >::ReceiverType*, const EventType& ), unsigned long nIterations )
+{
+	typedef Facade::SimpleConverter< EventType > Converter;
+	CountingReceiver receiver;
+	// volatile keeps the compiler from calling the receiver directly, the sinks only know the interface
+	typename Converter::ReceiverType* volatile pReceiver( &receiver );
+
+	boost::function< void( const EventType& ) > bound( boost::bind( callback, pReceiver, _1 ) );
+	Stopwatch before;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+		bound( e );
+	report( sName + " bound callback", before, nIterations );
+
+	// the sink keeps the converted event between events
+	typename Converter::SimpleType simple;
+	Stopwatch after;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+	{
+		Converter::convert( e, simple );
+		Converter::dispatch( pReceiver, simple );
+	}
+	report( sName + " converter traits", after, nIterations );
+
+	return check( receiver.nEvents == 2 * nIterations, sName + " events were lost" );
+}
+
+} // anonymous namespace
+
+
+unsigned dispatch( unsigned long nIterations )
+{
+	const Math::Pose pose( Math::Quaternion( 0.1, -0.2, 0.3, 0.9273618495495703 ), Math::Vector< double, 3 >( 1.5, -2.0, 0.25 ) );
+	std::vector< Math::Vector< double, 3 > > positions;
+	for ( int i = 0; i < 16; i++ )
+		positions.push_back( Math::Vector< double, 3 >( i * 0.1, i, -i / 7.0 ) );
+
+	unsigned nFailed = 0;
+	nFailed += compareDispatch( "Pose", Measurement::Pose( 1000, pose ), &poseCallback, nIterations );
+	nFailed += compareDispatch( "PositionList[16]", Measurement::PositionList( 1000, positions ), &positionListCallback, nIterations );
+	return nFailed;
+}
+
+} } // namespace Ubitrack::Benchmark
@@ -0,0 +1,166 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Compares Facade::TextParser with Util::SimpleStringIArchive, the two ways
+ * ApplicationPushSource::receiveString reads a string.
+ */
+
+#include <vector>
+#include <utMeasurement/Measurement.h>
+#include <utUtil/SimpleStringIArchive.h>
+#include <utUtil/SimpleStringOArchive.h>
+#include <utFacade/TextParser.h>
+
+#include "Benchmark.h"
+
+namespace Ubitrack { namespace Benchmark {
+
+namespace {
+
+const Measurement::Timestamp g_time = 1500000000123456789ULL;
+
+template< class EventType >
+std::string serialize( const EventType& e )
+{
+	Util::SimpleStringOArchive ar;
+	ar << e;
+	return ar.str();
+}
+
+/** reads a string like ApplicationPushSource::parseArchive */
+template< class EventType >
+void parseArchive( const char* s, EventType& e )
+{
+	Util::SimpleStringIArchive ar( s );
+	e = EventType( boost::shared_ptr< typename EventType::value_type >( new typename EventType::value_type() ) );
+	ar >> e;
+}
+
+/** reads the string of \p e with both parsers and compares the results written back with the original */
+template< class EventType >
+unsigned roundTrip( const std::string& sName, const EventType& e )
+{
+	const std::string s( serialize( e ) );
+	unsigned nFailed = 0;
+
+	EventType fast;
+	nFailed += check( Facade::TextParser< EventType >::supported(), sName + " is not supported by the text parser" );
+	nFailed += check( Facade::TextParser< EventType >::parse( s.c_str(), fast ) && serialize( fast ) == s,
+		sName + " does not round-trip through the text parser: " + s );
+
+	try
+	{
+		EventType archive;
+		parseArchive( s.c_str(), archive );
+		nFailed += check( serialize( archive ) == s, sName + " does not round-trip through the archive: " + s );
+	}
+	catch ( const std::exception& ex )
+	{
+		nFailed += check( false, sName + " cannot be read by the archive: " + ex.what() );
+	}
+	return nFailed;
+}
+
+/** round-trips lists with 0, 1 and \p nElements elements */
+template< class EventType >
+unsigned roundTripLists( const std::string& sName, const typename EventType::value_type& elements )
+{
+	unsigned nFailed = 0;
+	typename EventType::value_type list;
+	nFailed += roundTrip( sName + "[0]", EventType( g_time, list ) );
+	list.push_back( elements.front() );
+	nFailed += roundTrip( sName + "[1]", EventType( g_time, list ) );
+	nFailed += roundTrip( sName + "[n]", EventType( g_time, elements ) );
+	return nFailed;
+}
+
+/** times both parsers on the string of \p e */
+template< class EventType >
+void timeParsers( const std::string& sName, const EventType& e, unsigned long nIterations )
+{
+	const std::string s( serialize( e ) );
+	EventType result;
+	Measurement::Timestamp nSum = 0;
+
+	Stopwatch fast;
+	for ( unsigned long i = 0; i < nIterations; i++ )
+	{
+		Facade::TextParser< EventType >::parse( s.c_str(), result );
+		nSum += result.time();
+	}
+	report( sName + " text parser", fast, nIterations );
+
+	// the archive is much slower
+	const unsigned long nArchiveIterations = nIterations / 10 + 1;
+	Stopwatch archive;
+	for ( unsigned long i = 0; i < nArchiveIterations; i++ )
+	{
+		parseArchive( s.c_str(), result );
+		nSum += result.time();
+	}
+	report( sName + " archive", archive, nArchiveIterations );
+
+	// keeps the loops from being optimized away
+	if ( nSum == 1 )
+		std::cout << nSum << std::endl;
+}
+
+} // anonymous namespace
+
+
+unsigned textParser( unsigned long nIterations )
+{
+	const Math::Quaternion rotation( 0.1, -0.2, 0.3, 0.9273618495495703 );
+	const Math::Vector< double, 3 > position( 1.5, -2e-7, 1.0 / 3.0 );
+	const Math::Vector< double, 2 > position2D( 640.25, -0.125 );
+	const Math::Pose pose( rotation, position );
+
+	std::vector< Math::Vector< double, 3 > > positions;
+	std::vector< Math::Vector< double, 2 > > positions2D;
+	std::vector< Math::Pose > poses;
+	for ( int i = 0; i < 16; i++ )
+	{
+		positions.push_back( Math::Vector< double, 3 >( i * 0.1, i, -i / 7.0 ) );
+		positions2D.push_back( Math::Vector< double, 2 >( i * 0.1, -i / 7.0 ) );
+		poses.push_back( Math::Pose( rotation, Math::Vector< double, 3 >( i, 0.5, -i * 1e-3 ) ) );
+	}
+
+	// the types registered as ApplicationPushSource
+	unsigned nFailed = 0;
+	nFailed += roundTrip( "Button", Measurement::Button( g_time, Math::Scalar< int >( -5 ) ) );
+	nFailed += roundTrip( "Rotation", Measurement::Rotation( g_time, rotation ) );
+	nFailed += roundTrip( "Position", Measurement::Position( g_time, position ) );
+	nFailed += roundTripLists< Measurement::PositionList >( "PositionList", positions );
+	nFailed += roundTrip( "Position2D", Measurement::Position2D( g_time, position2D ) );
+	nFailed += roundTripLists< Measurement::PositionList2 >( "PositionList2", positions2D );
+	nFailed += roundTrip( "Pose", Measurement::Pose( g_time, pose ) );
+	nFailed += roundTripLists< Measurement::PoseList >( "PoseList", poses );
+
+	timeParsers( "Pose", Measurement::Pose( g_time, pose ), nIterations );
+	timeParsers( "PositionList[16]", Measurement::PositionList( g_time, positions ), nIterations / 10 + 1 );
+	return nFailed;
+}
+
+} } // namespace Ubitrack::Benchmark
@@ -0,0 +1,123 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @file
+ * Microbenchmarks and consistency checks of the facade fast paths.
+ * Runs the sections given on the command line, or all of them, and
+ * returns non-zero if a check failed.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "Benchmark.h"
+
+using namespace Ubitrack;
+
+namespace {
+
+struct NamedSection
+{
+	const char* sName;
+	Benchmark::Section section;
+};
+
+const NamedSection g_sections[] = {
+	{ "text", &Benchmark::textParser },
+	{ "clock", &Benchmark::facadeClock },
+	{ "dispatch", &Benchmark::dispatch },
+};
+
+const std::size_t g_nSections = sizeof( g_sections ) / sizeof( g_sections[ 0 ] );
+
+} // anonymous namespace
+
+
+int main( int ac, char** av )
+{
+	unsigned long nIterations;
+	std::vector< std::string > sections;
+
+	try
+	{
+		namespace po = boost::program_options;
+		po::options_description poDesc( "Allowed options", 80 );
+		poDesc.add_options()
+			( "help", "print this help message" )
+			( "iterations,n", po::value< unsigned long >( &nIterations )->default_value( 1000000 ), "iterations of each timed loop" )
+			( "section", po::value< std::vector< std::string > >( &sections ), "section to run, all if none is given" )
+		;
+
+		po::positional_options_description inputOptions;
+		inputOptions.add( "section", -1 );
+
+		po::variables_map poOptions;
+		po::store( po::command_line_parser( ac, av ).options( poDesc ).positional( inputOptions ).run(), poOptions );
+		po::notify( poOptions );
+
+		if ( poOptions.count( "help" ) )
+		{
+			std::cout << "Syntax: utBenchmark [options] [section...]" << std::endl << std::endl;
+			std::cout << poDesc << std::endl << "Sections:";
+			for ( std::size_t i = 0; i < g_nSections; i++ )
+				std::cout << " " << g_sections[ i ].sName;
+			std::cout << std::endl;
+			return 1;
+		}
+
+		for ( std::size_t j = 0; j < sections.size(); j++ )
+		{
+			bool bKnown = false;
+			for ( std::size_t i = 0; i < g_nSections; i++ )
+				bKnown |= sections[ j ] == g_sections[ i ].sName;
+			if ( !bKnown )
+				throw std::invalid_argument( "unknown section " + sections[ j ] );
+		}
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << "Error parsing command line parameters : " << e.what() << std::endl;
+		std::cerr << "Try utBenchmark --help for help" << std::endl;
+		return 1;
+	}
+
+	unsigned nFailed = 0;
+	for ( std::size_t i = 0; i < g_nSections; i++ )
+	{
+		bool bSelected = sections.empty();
+		for ( std::size_t j = 0; j < sections.size(); j++ )
+			bSelected |= sections[ j ] == g_sections[ i ].sName;
+		if ( !bSelected )
+			continue;
+
+		std::cout << g_sections[ i ].sName << ":" << std::endl;
+		nFailed += g_sections[ i ].section( nIterations );
+	}
+
+	if ( nFailed )
+		std::cout << nFailed << " checks failed" << std::endl;
+	return nFailed ? 2 : 0;
+}
@@ -24,6 +24,9 @@ SWIG */
 
 %include "arrays_csharp.i";
 
+/* caller-owned buffers of the list pull sinks map to double[] */
+%apply double OUTPUT[] { double* pPositions, double* pCovariances }
+
 // These typemaps cause parameters of type TYPE named ARGNAME to become IntPtr in C#.
 %define %cs_marshal_intptr(TYPE, ARGNAME...)
         %typemap(ctype)  TYPE ARGNAME "void*"
@@ -56,6 +59,9 @@ SWIG */
 
 %include "arrays_java.i";
 
+/* caller-owned buffers of the list pull sinks map to double[] */
+%apply double[] { double* pPositions, double* pCovariances }
+
 #endif
 
 
@@ -71,6 +77,7 @@ Java methods.  This must come before the C/C++ declarations to be wrapped. */
 %feature("director") SimpleDistanceReceiver;
 %feature("director") SimpleButtonReceiver;
 %feature("director") SimpleStringReceiver;
+%feature("director") SimpleBinaryReceiver;
 %feature("director") SimpleImageReceiver;
 %feature("director") SimpleDataflowObserver;
 
@@ -81,10 +88,17 @@ Java methods.  This must come before the C/C++ declarations to be wrapped. */
 %feature("director") SimplePositionList3DReceiver;
 %feature("director") SimpleErrorPositionList3DReceiver;
 
-/* Needed to transfer memory ownership to Java, e.g. for C++ factory methods 
-which create and return objects that are not known/owned/used in C++ code */
+%feature("director") SimplePoseBatchReceiver;
+%feature("director") SimpleErrorPoseBatchReceiver;
+%feature("director") SimplePosition2DBatchReceiver;
+%feature("director") SimplePosition3DBatchReceiver;
+%feature("director") SimpleErrorPosition3DBatchReceiver;
+%feature("director") SimpleMatrix3x4BatchReceiver;
+%feature("director") SimpleMatrix4x4BatchReceiver;
+%feature("director") SimpleDistanceBatchReceiver;
+%feature("director") SimpleButtonBatchReceiver;
 
-%newobject Ubitrack::Facade::SimpleFacade::getSimplePullSinkPose( const char * );
+/* The pull sink proxies are owned by the SimpleFacade, so no %newobject here */
 
 
 
@@ -141,6 +155,15 @@ generate generic type wrapper classes of style SWITTYPE_p_<xxx>. */
 %include ../../src/utFacade/SimpleDatatypes.h
 %include ../../src/utFacade/SimpleFacade.h
 
+/* arrays for pullSnapshot and the get*Range methods of the pull sinks */
+%array_class(int, intArrayClass);
+%array_class(Ubitrack::Facade::SimplePose, SimplePoseArray);
+%array_class(Ubitrack::Facade::SimpleErrorPose, SimpleErrorPoseArray);
+%array_class(Ubitrack::Facade::SimplePullStatus, SimplePullStatusArray);
+%array_class(Ubitrack::Facade::SimplePosition3D, SimplePosition3DArray);
+%array_class(Ubitrack::Facade::SimplePosition2D, SimplePosition2DArray);
+%array_class(Ubitrack::Facade::SimpleButton, SimpleButtonArray);
+
 %include ../../../utcore/src/utUtil/Logging.h
 
 
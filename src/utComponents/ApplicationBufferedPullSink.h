@@ -0,0 +1,289 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Pull sink for the application that is fed by a push input.
+ * The sink keeps a history of the pushed measurements and answers pull requests
+ * by interpolating between them.
+ */
+
+#ifndef __UBITRACK_COMPONENTS_APPLICATIONBUFFEREDPULLSINK_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_APPLICATIONBUFFEREDPULLSINK_H_INCLUDED__
+
+#include <math.h>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+#include <utDataflow/PushConsumer.h>
+#include <utMath/Vector.h>
+#include <utMath/Quaternion.h>
+#include <utMath/Pose.h>
+#include "ApplicationPullSink.h"
+
+namespace Ubitrack { namespace Components {
+
+/**
+ * Interpolation between two measurements of an ApplicationBufferedPullSink.
+ * The default holds the older measurement.
+ */
+template< class EventType >
+struct BufferedPullInterpolation
+{
+	/**
+	 * @param a measurement before the requested timestamp
+	 * @param b measurement after the requested timestamp
+	 * @param t the requested timestamp
+	 * @param w weight of \p b between 0 and 1
+	 */
+	static EventType interpolate( const EventType& a, const EventType&, Measurement::Timestamp, double )
+	{ return a; }
+};
+
+/** linear interpolation of two vectors */
+inline Math::Vector< double, 3 > interpolateVector( const Math::Vector< double, 3 >& a, const Math::Vector< double, 3 >& b, double w )
+{
+	Math::Vector< double, 3 > v;
+	for ( int i = 0; i < 3; i++ )
+		v[ i ] = a[ i ] + w * ( b[ i ] - a[ i ] );
+	return v;
+}
+
+/** spherical linear interpolation of two rotations along the shorter arc */
+inline Math::Quaternion slerpQuaternion( const Math::Quaternion& a, const Math::Quaternion& b, double w )
+{
+	double d = a.x() * b.x() + a.y() * b.y() + a.z() * b.z() + a.w() * b.w();
+	double fSign = 1.0;
+	if ( d < 0.0 )
+	{
+		d = -d;
+		fSign = -1.0;
+	}
+
+	double wa = 1.0 - w;
+	double wb = w;
+	// close rotations are interpolated linearly to avoid dividing by sin( 0 )
+	if ( d < 0.9995 )
+	{
+		double theta = acos( d );
+		double sinTheta = sin( theta );
+		wa = sin( wa * theta ) / sinTheta;
+		wb = sin( wb * theta ) / sinTheta;
+	}
+	wb *= fSign;
+
+	double x = wa * a.x() + wb * b.x();
+	double y = wa * a.y() + wb * b.y();
+	double z = wa * a.z() + wb * b.z();
+	double qw = wa * a.w() + wb * b.w();
+	double n = sqrt( x * x + y * y + z * z + qw * qw );
+	return Math::Quaternion( x / n, y / n, z / n, qw / n );
+}
+
+template<>
+struct BufferedPullInterpolation< Measurement::Position >
+{
+	static Measurement::Position interpolate( const Measurement::Position& a, const Measurement::Position& b, Measurement::Timestamp t, double w )
+	{ return Measurement::Position( t, interpolateVector( *a, *b, w ) ); }
+};
+
+template<>
+struct BufferedPullInterpolation< Measurement::Rotation >
+{
+	static Measurement::Rotation interpolate( const Measurement::Rotation& a, const Measurement::Rotation& b, Measurement::Timestamp t, double w )
+	{ return Measurement::Rotation( t, slerpQuaternion( *a, *b, w ) ); }
+};
+
+template<>
+struct BufferedPullInterpolation< Measurement::Pose >
+{
+	static Measurement::Pose interpolate( const Measurement::Pose& a, const Measurement::Pose& b, Measurement::Timestamp t, double w )
+	{
+		return Measurement::Pose( t, Math::Pose( slerpQuaternion( a->rotation(), b->rotation(), w ),
+			interpolateVector( a->translation(), b->translation(), w ) ) );
+	}
+};
+
+/**
+ * @ingroup dataflow_components
+ * Pull sink for the application with a push input.
+ *
+ * Many trackers only push their measurements. This sink keeps the last measurements
+ * in a time-ordered ring buffer and answers the pull requests of the application
+ * from it, so no separate interpolation component is needed in front of an
+ * ApplicationPullSink. It offers the same interface as ApplicationPullSink,
+ * including the cache and tryGet, so the SimpleFacade pull sink proxies work with it.
+ *
+ * @par Input Ports
+ * PushConsumer<EventType> port with name "Input".
+ *
+ * @par Output Ports
+ * None.
+ *
+ * @par Configuration
+ * - \c historySize: number of measurements kept (default 64)
+ * - the attributes of ApplicationPullSink
+ *
+ * @par Operation
+ * A request for timestamp t is answered by a binary search in the history:
+ * - t between two measurements: poses, positions and rotations are interpolated
+ *   linearly (rotations by SLERP), other types return the older measurement
+ * - t after the newest measurement: the newest measurement with its own timestamp,
+ *   so that \c staleAfterMs can detect a stalled input. The pose and position proxies
+ *   of the SimpleFacade can predict from it, see \c setExtrapolation.
+ * - t before the oldest measurement or an empty history: an exception
+ *
+ * Measurements that are older than the newest one in the history are dropped.
+ * The history is allocated when the component is created; lookups only allocate the
+ * interpolated result.
+ *
+ * @par Instances
+ * - Ubitrack::Measurement::Pose : ApplicationBufferedPullSinkPose
+ * - Ubitrack::Measurement::Position : ApplicationBufferedPullSinkPosition
+ * - Ubitrack::Measurement::Rotation : ApplicationBufferedPullSinkRotation
+ */
+template< class EventType >
+class ApplicationBufferedPullSink
+	: public ApplicationPullSink< EventType >
+{
+public:
+	/**
+	 * UTQL component constructor.
+	 *
+	 * @param sName Unique name of the component.
+	 * @param subgraph UTQL subgraph
+	 */
+	ApplicationBufferedPullSink( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph > pConfig )
+		: ApplicationPullSink< EventType >( nm, pConfig, false )
+		, m_PushInPort( "Input", *this, boost::bind( &ApplicationBufferedPullSink::receive, this, _1 ) )
+		, m_nFirst( 0 )
+		, m_nCount( 0 )
+	{
+		int nHistorySize = 64;
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "historySize" ) )
+			pConfig->m_DataflowAttributes.getAttributeData( "historySize", nHistorySize );
+		if ( nHistorySize < 1 )
+			UBITRACK_THROW( "historySize must be positive in component " + nm );
+
+		m_history.resize( nHistorySize );
+	}
+
+	/** clears the history */
+	virtual void start()
+	{
+		{
+			boost::mutex::scoped_lock lock( m_historyMutex );
+			m_nFirst = 0;
+			m_nCount = 0;
+		}
+		ApplicationPullSink< EventType >::start();
+	}
+
+protected:
+	/** adds a pushed measurement to the history */
+	void receive( const EventType& e )
+	{
+		boost::mutex::scoped_lock lock( m_historyMutex );
+		if ( m_nCount )
+		{
+			EventType& newest( at( m_nCount - 1 ) );
+			if ( e.time() < newest.time() )
+				return;
+			if ( e.time() == newest.time() )
+			{
+				newest = e;
+				return;
+			}
+		}
+
+		if ( m_nCount < m_history.size() )
+			at( m_nCount++ ) = e;
+		else
+		{
+			// overwrite the oldest measurement
+			m_history[ m_nFirst ] = e;
+			m_nFirst = ( m_nFirst + 1 ) % m_history.size();
+		}
+	}
+
+	/** answers a request from the history */
+	virtual EventType pullInput( Measurement::Timestamp t )
+	{
+		boost::mutex::scoped_lock lock( m_historyMutex );
+		if ( m_nCount == 0 )
+			UBITRACK_THROW( "No measurement received yet by " + this->getName() );
+
+		if ( t >= at( m_nCount - 1 ).time() )
+			return at( m_nCount - 1 );
+		if ( t < at( 0 ).time() )
+			UBITRACK_THROW( "Requested timestamp is older than the history of " + this->getName() );
+
+		// find the first measurement newer than t, which exists because of the checks above
+		std::size_t nLow = 0;
+		std::size_t nHigh = m_nCount - 1;
+		while ( nLow < nHigh )
+		{
+			std::size_t nMid = ( nLow + nHigh ) / 2;
+			if ( at( nMid ).time() <= t )
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+
+		const EventType& a( at( nLow - 1 ) );
+		const EventType& b( at( nLow ) );
+		if ( a.time() == t )
+			return a;
+
+		double w = static_cast< double >( t - a.time() ) / static_cast< double >( b.time() - a.time() );
+		return BufferedPullInterpolation< EventType >::interpolate( a, b, t, w );
+	}
+
+	/** i-th oldest measurement, \c m_historyMutex must be locked */
+	EventType& at( std::size_t i )
+	{ return m_history[ ( m_nFirst + i ) % m_history.size() ]; }
+
+	/** push input */
+	PushConsumer< EventType > m_PushInPort;
+
+	/** ring buffer of the last measurements */
+	std::vector< EventType > m_history;
+
+	/** index of the oldest measurement in \c m_history */
+	std::size_t m_nFirst;
+
+	/** number of measurements in \c m_history */
+	std::size_t m_nCount;
+
+	/** protects the history */
+	boost::mutex m_historyMutex;
+};
+
+typedef ApplicationBufferedPullSink< Measurement::Pose > ApplicationBufferedPullSinkPose;
+typedef ApplicationBufferedPullSink< Measurement::Position > ApplicationBufferedPullSinkPosition;
+typedef ApplicationBufferedPullSink< Measurement::Rotation > ApplicationBufferedPullSinkRotation;
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_APPLICATIONBUFFEREDPULLSINK_H_INCLUDED__
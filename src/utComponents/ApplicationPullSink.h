@@ -39,16 +39,48 @@
 #include <iostream>
 
 #include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <utDataflow/PullConsumer.h>
 #include <utDataflow/Component.h>
 #include <utDataflow/ComponentFactory.h>
 #include <utMeasurement/Measurement.h>
+#include <utUtil/Exception.h>
+#include <utGraph/UTQLSubgraph.h>
+#include <utFacade/SimpleDatatypes.h>
+#include <utComponents/TimestampCache.h>
 
 namespace Ubitrack { namespace Components {
 
 using namespace Dataflow;
 
+/**
+ * Common base class for application pull sinks.
+ * Allows controlling the result cache independent of the event type.
+ */
+class ApplicationPullSinkBase
+{
+public:
+	/**
+	 * Sets the number of cached results, 0 disables the cache. Clears the cache.
+	 * May be called while the dataflow is running.
+	 */
+	virtual void setCacheSize( std::size_t nEntries ) = 0;
+
+	/**
+	 * Fills in the cache statistics of the sink.
+	 * @param stats receives the statistics
+	 * @param bReset set the counters to 0 afterwards
+	 */
+	virtual void getCacheStatistics( Facade::SimplePullCacheStats& stats, bool bReset = false ) = 0;
+
+	/** virtual destructor */
+	virtual ~ApplicationPullSinkBase()
+	{}
+};
+
 /**
  * @ingroup dataflow_components
  * This is an sink component which may be used to interface
@@ -64,7 +96,14 @@ using namespace Dataflow;
  * None.
  *
  * @par Configuration
- * None.
+ * - \c cacheSize: number of results cached by timestamp, 0 (default) disables the cache
+ * - \c cacheInvalidation: \c restart (default) clears the cache when the dataflow is
+ *   started, \c never keeps the cached results
+ * - \c noDataRetryMs: while the sink has not delivered any measurement, tryGet answers
+ *   with \c PULL_NO_DATA for this many milliseconds after a failed request without
+ *   querying the dataflow network again. 0 (default) queries on every request.
+ * - \c staleAfterMs: tryGet reports \c PULL_STALE if the delivered measurement is older
+ *   than the requested timestamp by more than this many milliseconds. 0 (default) disables the check.
  *
  * @par Operation
  * Whenever the user requests a measurement via the get method
@@ -72,6 +111,15 @@ using namespace Dataflow;
  * is queried for the corresponding measurement. The user
  * has to supply the requested timestamp.
  *
+ * If the cache is enabled, the results of the last \c cacheSize requested timestamps
+ * are kept, so that several threads requesting the same timestamp (e.g. the timestamp
+ * of the current video frame) only query the dataflow network once. A cached result
+ * does not change if newer measurements arrive, so the cache should only be enabled
+ * if the same timestamps are requested shortly after each other.
+ *
+ * The tryGet method reports failures with a status code instead of an exception. The
+ * message of the last failure is only formatted when lastError is called.
+ *
  * @par Instances
  * Registered for the following EventTypes and names:
  * - Ubitrack::Measurement::Pose : ApplicationPullSinkPose
@@ -82,6 +130,7 @@ using namespace Dataflow;
 template < class EventType >
 class ApplicationPullSink
 	: public Component
+	, public ApplicationPullSinkBase
 {
 public:
 	/**
@@ -89,13 +138,52 @@ public:
 	 *
 	 * @param sName Unique name of the component.
 	 * @param subgraph UTQL subgraph
+	 * @param bPullInput create the pull input port. Derived classes that provide their own
+	 *   input set this to false and override pullInput.
 	 */
-	ApplicationPullSink( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph> )
+	ApplicationPullSink( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph> pConfig, bool bPullInput = true )
       : Ubitrack::Dataflow::Component( nm )
-      , m_InPort( "Input", *this )
+      , m_bClearCacheOnStart( true )
+      , m_nNoDataRetry( 0 )
+      , m_nStaleAfter( 0 )
+      , m_bReceived( false )
+      , m_noDataUntil( 0 )
     {
+		if ( bPullInput )
+			m_pInPort.reset( new PullConsumer< EventType >( "Input", *this ) );
+
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "cacheSize" ) )
+		{
+			int nCacheSize = 0;
+			pConfig->m_DataflowAttributes.getAttributeData( "cacheSize", nCacheSize );
+			if ( nCacheSize < 0 )
+				UBITRACK_THROW( "cacheSize must not be negative in component " + nm );
+			m_cache.setCapacity( nCacheSize );
+		}
+
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "cacheInvalidation" ) )
+		{
+			std::string sInvalidation( pConfig->m_DataflowAttributes.getAttributeString( "cacheInvalidation" ) );
+			if ( sInvalidation == "never" )
+				m_bClearCacheOnStart = false;
+			else if ( sInvalidation != "restart" )
+				UBITRACK_THROW( "Invalid cacheInvalidation \"" + sInvalidation + "\" in component " + nm );
+		}
+
+		m_nNoDataRetry = millisecondAttribute( pConfig, "noDataRetryMs" );
+		m_nStaleAfter = millisecondAttribute( pConfig, "staleAfterMs" );
     }
 
+	/** clears the cache unless \c cacheInvalidation is \c never */
+	virtual void start()
+	{
+		if ( m_bClearCacheOnStart )
+			m_cache.clear();
+		m_bReceived.store( false, boost::memory_order_relaxed );
+		m_noDataUntil.store( 0, boost::memory_order_relaxed );
+		Component::start();
+	}
+
 	/**
 	 * Get function as interface to user.
 	 * This function queries the dataflow network and delivers the
@@ -106,14 +194,125 @@ public:
 	 */
     EventType get( Ubitrack::Measurement::Timestamp t )
     {
-      return m_InPort.get ( t );
+		EventType e;
+		if ( m_cache.capacity() == 0 )
+			e = pullInput( t );
+		else if ( !m_cache.lookup( t, e ) )
+		{
+			e = pullInput( t );
+			m_cache.insert( t, e );
+		}
+
+		if ( !m_bReceived.load( boost::memory_order_relaxed ) )
+			m_bReceived.store( true, boost::memory_order_relaxed );
+		return e;
     }
 
+	/**
+	 * Like get, but reports failures with a status code.
+	 * Failures before the first delivered measurement are reported as \c PULL_NO_DATA, and are
+	 * not retried for \c noDataRetryMs. Later failures are reported as \c PULL_ERROR and
+	 * their message is kept for lastError.
+	 * @param t Timestamp for which the data is requested.
+	 * @param e receives the measurement if the result is \c PULL_OK or \c PULL_STALE
+	 */
+	Facade::SimplePullStatus tryGet( Ubitrack::Measurement::Timestamp t, EventType& e )
+	{
+		if ( m_nNoDataRetry && !m_bReceived.load( boost::memory_order_relaxed ) &&
+			Measurement::now() < m_noDataUntil.load( boost::memory_order_relaxed ) )
+			return Facade::PULL_NO_DATA;
+
+		try
+		{
+			e = get( t );
+		}
+		catch ( const Util::Exception& ex )
+		{
+			if ( !m_bReceived.load( boost::memory_order_relaxed ) )
+			{
+				if ( m_nNoDataRetry )
+					m_noDataUntil.store( Measurement::now() + m_nNoDataRetry, boost::memory_order_relaxed );
+				return Facade::PULL_NO_DATA;
+			}
+
+			boost::mutex::scoped_lock lock( m_errorMutex );
+			m_sLastError = ex.what();
+			return Facade::PULL_ERROR;
+		}
+
+		if ( m_nStaleAfter && e.time() + m_nStaleAfter < t )
+			return Facade::PULL_STALE;
+		return Facade::PULL_OK;
+	}
+
+	/** returns the message of the last failed tryGet */
+	std::string lastError()
+	{
+		if ( !m_bReceived.load( boost::memory_order_relaxed ) )
+			return "No measurement received yet by " + getName();
+
+		boost::mutex::scoped_lock lock( m_errorMutex );
+		return m_sLastError;
+	}
+
+	/** @copydoc ApplicationPullSinkBase::setCacheSize */
+	void setCacheSize( std::size_t nEntries )
+	{ m_cache.setCapacity( nEntries ); }
+
+	/** @copydoc ApplicationPullSinkBase::getCacheStatistics */
+	void getCacheStatistics( Facade::SimplePullCacheStats& stats, bool bReset = false )
+	{
+		stats.hits = m_cache.hits();
+		stats.misses = m_cache.misses();
+		stats.size = static_cast< unsigned int >( m_cache.capacity() );
+		if ( bReset )
+			m_cache.resetCounters();
+	}
+
 protected:
+	/** retrieves a measurement from the input of the sink */
+	virtual EventType pullInput( Ubitrack::Measurement::Timestamp t )
+	{ return m_pInPort->get( t ); }
+
+	/** reads an optional non-negative attribute in milliseconds and converts it to nanoseconds */
+	static Measurement::Timestamp millisecondAttribute( boost::shared_ptr< Graph::UTQLSubgraph > pConfig, const std::string& sName )
+	{
+		if ( !pConfig || !pConfig->m_DataflowAttributes.hasAttribute( sName ) )
+			return 0;
+
+		double ms = 0.0;
+		pConfig->m_DataflowAttributes.getAttributeData( sName, ms );
+		if ( ms < 0.0 )
+			UBITRACK_THROW( sName + " must not be negative" );
+		return static_cast< Measurement::Timestamp >( ms * 1e6 );
+	}
+
 	/**
-	 * Input port of the function.
+	 * Input port of the function, NULL if a derived class provides the input.
 	 */
-	PullConsumer< EventType > m_InPort;
+	boost::scoped_ptr< PullConsumer< EventType > > m_pInPort;
+
+	/** results of recent requests */
+	TimestampCache< EventType > m_cache;
+
+	/** clear the cache when the dataflow is started? */
+	bool m_bClearCacheOnStart;
+
+	/** time in ns during which a missing measurement is not requested again */
+	Measurement::Timestamp m_nNoDataRetry;
+
+	/** age in ns after which tryGet reports a measurement as stale, 0 to disable */
+	Measurement::Timestamp m_nStaleAfter;
+
+	/** has a measurement been delivered since the dataflow was started? */
+	boost::atomic< bool > m_bReceived;
+
+	/** tryGet reports \c PULL_NO_DATA without requesting until this time */
+	boost::atomic< Measurement::Timestamp > m_noDataUntil;
+
+	/** message of the last failed tryGet */
+	std::string m_sLastError;
+	boost::mutex m_errorMutex;
 };
 
 typedef ApplicationPullSink< Measurement::Pose > ApplicationPullSinkPose;
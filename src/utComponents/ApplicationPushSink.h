@@ -39,47 +39,216 @@
 #define APPLICATIONPUSHSINK_NOLOGGING
 
 #include <string>
+#include <vector>
 #include <iostream>
 
 #include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 
 #include <utDataflow/PushConsumer.h>
 #include <utDataflow/Component.h>
+#include <utGraph/UTQLSubgraph.h>
 #include <utMeasurement/Measurement.h>
+#include <utUtil/Exception.h>
 #include <utUtil/SimpleStringOArchive.h>
 #include <utFacade/SimpleDatatypes.h>
+#include <utFacade/Trace.h>
+#include <utFacade/SimpleConverters.h>
+#include <utFacade/BinaryCodec.h>
+#include <utComponents/LatencyHistogram.h>
+#include <utComponents/SeqlockSlot.h>
 #ifndef APPLICATIONPUSHSINK_NOLOGGING
 #include <log4cpp/Category.hh>
 #endif
 
-// forward decls
-namespace Ubitrack {
-	namespace Graph {
-		class UTQLSubgraph;
-	}
-}
-
 
 namespace Ubitrack { namespace Components {
 
 using namespace Dataflow;
 
+class ApplicationPushSinkBase;
+
+/**
+ * Interface of a thread pool that runs the callbacks of push sinks in
+ * \c DeliverExecutor mode. The pool is owned by the facade.
+ */
+class ApplicationPushSinkExecutor
+{
+public:
+	/** calls \c ApplicationPushSinkBase::runExecutorTask of the sink on one of the pool threads */
+	virtual void schedule( ApplicationPushSinkBase* pSink ) = 0;
+
+	/** virtual destructor */
+	virtual ~ApplicationPushSinkExecutor()
+	{}
+};
+
+
 /**
  * Common base class for application push sinks.
- * Allows setting string receivers.
+ * Allows setting string and binary receivers and controlling the event delivery.
  */
 class ApplicationPushSinkBase
 {
 public:
+	/** how events are handed to the application */
+	enum DeliveryMode
+	{
+		/** callback is called on the event queue thread (default) */
+		DeliverSynchronous,
+		/** events are queued and delivered by a consumer thread owned by the sink */
+		DeliverQueued,
+		/** events are queued and delivered when the application calls \c drain */
+		DeliverPolled,
+		/** events are queued and delivered on a thread of the executor set with \c setExecutor */
+		DeliverExecutor
+	};
+
+	/** which events are handed to the application if it falls behind */
+	enum DeliveryPolicy
+	{
+		/** every event is delivered in order, events arriving at a full queue are dropped */
+		PolicyFifo,
+		/** only the newest event is kept, older undelivered events are replaced */
+		PolicyLatest
+	};
+
 	/** sets a SimplePoseReceiver */
 	virtual void setStringCallback( Facade::SimpleStringReceiver* pReceiver ) = 0;
 
+	/**
+	 * Sets a receiver for the binary encoding of the events, see \c Facade::BinaryCodec.
+	 * Throws an exception if the event type has no binary encoding.
+	 */
+	virtual void setBinaryCallback( Facade::SimpleBinaryReceiver* pReceiver ) = 0;
+
+	/**
+	 * Adds a string receiver in addition to the existing subscribers.
+	 * @return handle for \c removeSubscriber, 0 if \p pReceiver is NULL
+	 */
+	virtual unsigned int addStringSubscriber( Facade::SimpleStringReceiver* pReceiver ) = 0;
+
+	/**
+	 * Adds a binary receiver in addition to the existing subscribers.
+	 * Throws an exception if the event type has no binary encoding.
+	 * @return handle for \c removeSubscriber, 0 if \p pReceiver is NULL
+	 */
+	virtual unsigned int addBinarySubscriber( Facade::SimpleBinaryReceiver* pReceiver ) = 0;
+
+	/**
+	 * Removes a subscriber added with one of the add functions. Waits for deliveries that
+	 * are already running, so the subscriber is not called any more once this returns and
+	 * may be deleted. Called from a callback of the same sink, it cannot wait; the
+	 * removed subscriber may then still be called by the current delivery.
+	 * @return false if there is no subscriber with this handle
+	 */
+	virtual bool removeSubscriber( unsigned int nHandle ) = 0;
+
+	/**
+	 * Delivers queued events on the calling thread.
+	 * Only has an effect in \c DeliverPolled mode, as the queue supports a single consumer.
+	 *
+	 * @param nMaxEvents maximum number of events to deliver, 0 delivers all queued events
+	 * @return number of delivered events
+	 */
+	virtual std::size_t drain( std::size_t nMaxEvents = 0 ) = 0;
+
+	/**
+	 * Sets the delivery policy. \c PolicyLatest requires asynchronous delivery, so a
+	 * sink in \c DeliverSynchronous mode switches to \c DeliverQueued.
+	 * Throws if the sink is running, it must be called before the dataflow is started.
+	 */
+	virtual void setDeliveryPolicy( DeliveryPolicy policy ) = 0;
+
+	/**
+	 * Sets the executor used in \c DeliverExecutor mode. Without an executor, such a sink
+	 * starts its own consumer thread like in \c DeliverQueued mode.
+	 * Must be called before the sink is started, later calls are ignored. The executor must outlive the sink.
+	 */
+	virtual void setExecutor( ApplicationPushSinkExecutor* pExecutor ) = 0;
+
+	/**
+	 * Delivers pending events, called by the executor. The sink schedules at most one task
+	 * at a time, so callbacks of one sink never run concurrently and keep the event order.
+	 * Exceptions of the callbacks are passed on after the remaining events were rescheduled.
+	 */
+	virtual void runExecutorTask() = 0;
+
+	/** fills in the delivery statistics of the sink */
+	virtual void getStatistics( Facade::SimplePushSinkStats& stats ) const = 0;
+
+	/**
+	 * Fills in the latency statistics of the sink.
+	 * @param stats receives the statistics since the last reset
+	 * @param bReset start a new measurement period afterwards
+	 */
+	virtual void getLatencyStatistics( Facade::SimpleLatencyStats& stats, bool bReset = false ) = 0;
+
+	/**
+	 * Creates an empty slot for the latest converted value of the sink, for \c setLatestValueSlot.
+	 * Throws an exception if the simple datatype of the sink has no fixed size.
+	 */
+	virtual boost::shared_ptr< SeqlockSlotBase > createLatestValueSlot() const = 0;
+
+	/**
+	 * Sets the slot in which the sink publishes the latest converted value of every received event,
+	 * in addition to the normal delivery. The sink keeps a reference to the slot.
+	 * Throws an exception if the slot was not created by a sink of the same type.
+	 */
+	virtual void setLatestValueSlot( boost::shared_ptr< SeqlockSlotBase > pSlot ) = 0;
+
 	/** virtual destructor. always good to have one. */
 	virtual ~ApplicationPushSinkBase()
 	{}
 };
 
 
+/**
+ * Creates and fills the latest value slot of a push sink.
+ * The primary template is used for simple datatypes without fixed size, which cannot be published.
+ */
+template< class SimpleType, bool bFixedSize = Facade::SimpleTypeIsFixedSize< SimpleType >::value >
+struct LatestValuePublisher
+{
+	typedef SeqlockSlotBase SlotType;
+
+	static boost::shared_ptr< SeqlockSlotBase > create()
+	{ UBITRACK_THROW( "The latest value of this sink type cannot be read" ); }
+
+	static SlotType* cast( SeqlockSlotBase* )
+	{ UBITRACK_THROW( "The latest value of this sink type cannot be read" ); }
+
+	template< class EventType >
+	static void publish( SlotType*, const EventType& )
+	{}
+};
+
+template< class SimpleType >
+struct LatestValuePublisher< SimpleType, true >
+{
+	typedef SeqlockSlot< SimpleType > SlotType;
+
+	static boost::shared_ptr< SeqlockSlotBase > create()
+	{ return boost::shared_ptr< SeqlockSlotBase >( new SlotType ); }
+
+	/** returns the typed slot, 0 if the slot holds another type */
+	static SlotType* cast( SeqlockSlotBase* pSlot )
+	{ return dynamic_cast< SlotType* >( pSlot ); }
+
+	template< class EventType >
+	static void publish( SlotType* pSlot, const EventType& m )
+	{
+		SimpleType value;
+		Facade::SimpleConverter< EventType >::convert( m, value );
+		pSlot->write( value );
+	}
+};
+
+
 /**
  * @ingroup dataflow_components
  * This is an sink component which may be used to interface
@@ -96,7 +265,10 @@ public:
  * None.
  *
  * @par Configuration
- * None.
+ * - \c deliveryMode: \c sync (default), \c queued, \c polled or \c executor, see \c ApplicationPushSinkBase::DeliveryMode
+ * - \c queueCapacity: number of events the hand-off queue can hold in \c queued, \c polled and \c executor mode (default 64)
+ * - \c deliveryPolicy: \c fifo (default) or \c latest, see \c ApplicationPushSinkBase::DeliveryPolicy.
+ *   \c latest implies \c queued delivery unless \c polled is set.
  *
  * @par Operation
  * Whenever the dataflow network pushes a new event to the
@@ -104,6 +276,54 @@ public:
  * the callback the user application has registered via
  * setCallback.
  *
+ * Applications using the simple datatypes register a receiver via setReceiver
+ * instead. The event is then converted with \c Facade::SimpleConverter<EventType>
+ * into a buffer owned by the sink and passed to the receiver by a direct virtual
+ * call, without a \c boost::function in between.
+ *
+ * Bindings without a typed receiver can register a \c Facade::SimpleBinaryReceiver
+ * via setBinaryCallback, which gets the events in the compact encoding of
+ * \c Facade::BinaryCodec instead of the text of setStringCallback.
+ *
+ * The set functions replace all consumers of the sink. Further callbacks and receivers
+ * can be added with the add functions, which return a handle for removeSubscriber.
+ * Each event is converted at most once per representation (simple datatype, binary,
+ * string) and passed to all subscribers. The subscriber list is copied on every change
+ * and published with an atomic pointer, so subscribers may be added and removed while
+ * the dataflow is running without locks on the delivery path. Changes of the consumers
+ * wait for running deliveries, unless they are made from a callback of the sink itself,
+ * so a removed receiver may be deleted right afterwards.
+ *
+ * In \c queued and \c polled mode, the event is instead written to a bounded
+ * lock-free single-producer/single-consumer queue and the callback is called either
+ * by a consumer thread owned by the sink or by the application via \c drain. A slow
+ * consumer thus no longer stalls the event queue. If the queue is full, the event is
+ * dropped and counted as overrun.
+ *
+ * With the \c latest policy, the queue is replaced by a single slot that is overwritten
+ * by newer events, so the consumer always receives the freshest event and the delivery
+ * latency is bounded by one callback. Replaced events are counted as conflated.
+ *
+ * In \c executor mode, the callbacks run on a thread pool shared by all sinks of the
+ * facade. Each sink has at most one task in the pool, which delivers up to
+ * \c s_nExecutorTaskEvents events and reschedules itself if more are pending. Different
+ * sinks thus run in parallel, while each sink keeps its event order.
+ *
+ * Instead of a per-event callback, the application can register a batch callback
+ * via setBatchCallback or a batch receiver via setBatchReceiver. Events are then collected and delivered in one call once
+ * the batch is full or the oldest collected event has waited for the configured
+ * window. Between events, the window is checked by the consumer thread in \c queued
+ * mode and in \c executor mode without an executor, and by \c drain in \c polled mode.
+ * In \c synchronous mode and on the executor pool no thread would deliver a partial
+ * batch before the next event, so a window is rejected there.
+ *
+ * The sink keeps histograms of the age of events on arrival (time of reception minus
+ * measurement timestamp) and of the time spent in the application callback.
+ *
+ * If a latest value slot is set with setLatestValueSlot, every received event is
+ * converted and written to the slot on the event queue thread, before it is handed
+ * to the delivery. Polling applications can read the slot from any thread without
+ * blocking the sink, see \c SeqlockSlot.
  */
 template <class EventType>
 class ApplicationPushSink
@@ -117,34 +337,476 @@ public:
 	 * @param sName Unique name of the component.
 	 * @param subgraph UTQL subgraph
 	 */
-	ApplicationPushSink( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph >  )
+	ApplicationPushSink( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph > pConfig )
 		: Ubitrack::Dataflow::Component( nm )
 		, m_InPort( "Input", *this, boost::bind( &ApplicationPushSink::pushHandler, this, _1 ) )
-		, m_callback( 0 )
+		, m_pSubscribers( 0 )
+		, m_nSubscriberReaders( 0 )
+		, m_nNextSubscriber( 1 )
+		, m_batchCallback( 0 )
+		, m_pBatchReceiver( 0 )
+		, m_bBatchActive( false )
+		, m_nBatchMaxEvents( 1 )
+		, m_nBatchMaxDelay( 0 )
+		, m_batchStart( 0 )
+		, m_deliveryMode( DeliverSynchronous )
+		, m_deliveryPolicy( PolicyFifo )
+		, m_nQueueCapacity( 64 )
+		, m_bHaveLatest( false )
+		, m_nReceived( 0 )
+		, m_nDelivered( 0 )
+		, m_nOverruns( 0 )
+		, m_nConflated( 0 )
+		, m_latencySince( Measurement::now() )
+		, m_bStarted( false )
+		, m_bConsumerWaiting( false )
+		, m_bStopConsumer( false )
+		, m_pExecutor( 0 )
+		, m_bTaskScheduled( false )
+		, m_pLatestValueSlot( 0 )
 #ifndef APPLICATIONPUSHSINK_NOLOGGING
 		, m_logger( log4cpp::Category::getInstance( "Ubitrack.Components.ApplicationPushSink" ) )
 #endif
 	{
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "deliveryMode" ) )
+		{
+			std::string sMode( pConfig->m_DataflowAttributes.getAttributeString( "deliveryMode" ) );
+			if ( sMode == "queued" )
+				m_deliveryMode = DeliverQueued;
+			else if ( sMode == "polled" )
+				m_deliveryMode = DeliverPolled;
+			else if ( sMode == "executor" )
+				m_deliveryMode = DeliverExecutor;
+			else if ( sMode != "sync" )
+				UBITRACK_THROW( "Invalid deliveryMode \"" + sMode + "\" in component " + nm );
+		}
+
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "queueCapacity" ) )
+			pConfig->m_DataflowAttributes.getAttributeData( "queueCapacity", m_nQueueCapacity );
+
+		if ( m_nQueueCapacity < 1 )
+			UBITRACK_THROW( "queueCapacity must be positive in component " + nm );
+
+		if ( pConfig && pConfig->m_DataflowAttributes.hasAttribute( "deliveryPolicy" ) )
+		{
+			std::string sPolicy( pConfig->m_DataflowAttributes.getAttributeString( "deliveryPolicy" ) );
+			if ( sPolicy == "latest" )
+				setDeliveryPolicy( PolicyLatest );
+			else if ( sPolicy != "fifo" )
+				UBITRACK_THROW( "Invalid deliveryPolicy \"" + sPolicy + "\" in component " + nm );
+		}
+
+		if ( m_deliveryMode != DeliverSynchronous && !m_pQueue )
+			m_pQueue.reset( new QueueType( m_nQueueCapacity ) );
+	}
+
+	/** stops the consumer thread, if any */
+	~ApplicationPushSink()
+	{
+		stopConsumer();
+
+		boost::mutex::scoped_lock lock( m_subscriberMutex );
+		publishSubscribers( 0 );
+		deleteRetiredSubscribers();
 	}
 
+	/** type of batch callbacks, receiving an array of events and its size */
+	typedef boost::function< void( const EventType*, std::size_t ) > BatchSlotType;
+
+	/** conversion of the events to the simple datatypes */
+	typedef Facade::SimpleConverter< EventType > ConverterType;
+	typedef typename ConverterType::SimpleType SimpleType;
+	typedef typename ConverterType::ReceiverType ReceiverType;
+	typedef typename ConverterType::BatchReceiverType BatchReceiverType;
+	typedef LatestValuePublisher< SimpleType > LatestValuePublisherType;
+
 	/**
 	 * Set the callback.
 	 * Set the callback in the user application which will be called for
-	 * incoming events.
+	 * incoming events. Replaces any other callback or receiver.
 	 * @param slot callback function of the user application.
 	 */
 	void setCallback ( typename PushConsumer< EventType >::SlotType slot )
 	{
-		m_callback = slot;
+		Subscriber subscriber;
+		subscriber.callback = slot;
+		replaceSubscribers( subscriber );
+	}
+
+	/**
+	 * Set a receiver for the simple datatype of the events.
+	 * Replaces any other callback or receiver.
+	 * @param pReceiver receiver interface of the user application.
+	 */
+	void setReceiver( ReceiverType* pReceiver )
+	{
+		Subscriber subscriber;
+		subscriber.pReceiver = pReceiver;
+		replaceSubscribers( subscriber );
 	}
 
 	/** sets a string receiver */
 	void setStringCallback( Facade::SimpleStringReceiver* pReceiver )
 	{
-		m_callback = boost::bind( &ApplicationPushSink< EventType >::sendString, _1, pReceiver );
+		Subscriber subscriber;
+		subscriber.pStringReceiver = pReceiver;
+		replaceSubscribers( subscriber );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::setBinaryCallback */
+	void setBinaryCallback( Facade::SimpleBinaryReceiver* pReceiver )
+	{
+		checkBinarySupport();
+		Subscriber subscriber;
+		subscriber.pBinaryReceiver = pReceiver;
+		replaceSubscribers( subscriber );
+	}
+
+	/**
+	 * Adds a callback in addition to the existing subscribers.
+	 * May be called while the dataflow is running.
+	 * @return handle for \c removeSubscriber, 0 if \p slot is empty
+	 */
+	unsigned int addCallback( typename PushConsumer< EventType >::SlotType slot )
+	{
+		Subscriber subscriber;
+		subscriber.callback = slot;
+		return addSubscriber( subscriber );
+	}
+
+	/**
+	 * Adds a receiver for the simple datatype in addition to the existing subscribers.
+	 * May be called while the dataflow is running.
+	 * @return handle for \c removeSubscriber, 0 if \p pReceiver is NULL
+	 */
+	unsigned int addReceiver( ReceiverType* pReceiver )
+	{
+		Subscriber subscriber;
+		subscriber.pReceiver = pReceiver;
+		return addSubscriber( subscriber );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::addStringSubscriber */
+	unsigned int addStringSubscriber( Facade::SimpleStringReceiver* pReceiver )
+	{
+		Subscriber subscriber;
+		subscriber.pStringReceiver = pReceiver;
+		return addSubscriber( subscriber );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::addBinarySubscriber */
+	unsigned int addBinarySubscriber( Facade::SimpleBinaryReceiver* pReceiver )
+	{
+		checkBinarySupport();
+		Subscriber subscriber;
+		subscriber.pBinaryReceiver = pReceiver;
+		return addSubscriber( subscriber );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::removeSubscriber */
+	bool removeSubscriber( unsigned int nHandle )
+	{
+		boost::mutex::scoped_lock lock( m_subscriberMutex );
+		const SubscriberList* pOld = m_pSubscribers.load();
+		if ( !pOld )
+			return false;
+
+		SubscriberList* pNew = new SubscriberList;
+		for ( typename std::vector< Subscriber >::const_iterator it = pOld->subscribers.begin(); it != pOld->subscribers.end(); ++it )
+			if ( it->nHandle != nHandle )
+				pNew->add( *it );
+
+		if ( pNew->subscribers.size() == pOld->subscribers.size() )
+		{
+			delete pNew;
+			return false;
+		}
+
+		if ( pNew->subscribers.empty() )
+		{
+			delete pNew;
+			pNew = 0;
+		}
+		publishSubscribers( pNew );
+		waitForSubscriberReaders();
+		return true;
+	}
+
+	/**
+	 * Set a batch callback.
+	 * Events are collected and passed to the callback in one call when \p nMaxEvents
+	 * events have been collected or the first collected event is older than
+	 * \p nMaxDelayUs microseconds. Replaces any per-event callback. Subscribers
+	 * added later take precedence over the batch callback.
+	 *
+	 * Must not be called while events are delivered.
+	 * Throws if \p nMaxDelayUs is set in \c synchronous mode or on the executor pool,
+	 * where no thread would deliver a partial batch after the window.
+	 *
+	 * @param slot callback function of the user application.
+	 * @param nMaxEvents maximum number of events per call, at least 1
+	 * @param nMaxDelayUs maximum time an event waits for the batch to fill up, 0 to only deliver full batches
+	 */
+	void setBatchCallback( BatchSlotType slot, std::size_t nMaxEvents, unsigned long long nMaxDelayUs )
+	{
+		checkBatchWindow( nMaxDelayUs );
+		clearConsumers();
+		configureBatch( nMaxEvents, nMaxDelayUs );
+		m_batchCallback = slot;
+		m_bBatchActive.store( true );
+	}
+
+	/**
+	 * Set a batch receiver for the simple datatype of the events.
+	 * Works like setBatchCallback, the events are converted into a buffer owned by the sink.
+	 */
+	void setBatchReceiver( BatchReceiverType* pReceiver, std::size_t nMaxEvents, unsigned long long nMaxDelayUs )
+	{
+		checkBatchWindow( nMaxDelayUs );
+		clearConsumers();
+		configureBatch( nMaxEvents, nMaxDelayUs );
+		m_simpleBatch.reserve( m_nBatchMaxEvents );
+		m_pBatchReceiver = pReceiver;
+		m_bBatchActive.store( true );
+	}
+
+	/** starts the consumer thread in \c queued mode, or in \c executor mode without an executor */
+	virtual void start()
+	{
+		m_bStarted.store( true );
+		bool bOwnThread = m_deliveryMode == DeliverQueued || ( m_deliveryMode == DeliverExecutor && !m_pExecutor );
+		if ( bOwnThread && !m_pConsumerThread )
+		{
+			m_bStopConsumer.store( false );
+			m_pConsumerThread.reset( new boost::thread( boost::bind( &ApplicationPushSink::consumerThread, this ) ) );
+		}
+		Component::start();
+	}
+
+	/**
+	 * stops the consumer thread in \c queued mode and delivers a pending batch.
+	 * Throws if called from a callback that runs on the consumer thread or executor task of this sink.
+	 */
+	virtual void stop()
+	{
+		// the consumer thread or executor task would have to wait for itself
+		if ( ( m_pConsumerThread || m_bTaskScheduled.load() ) && SubscriberReadGuard::delivering( *this ) )
+			UBITRACK_THROW( "Component " + getName() + " cannot be stopped from its own callback" );
+
+		Component::stop();
+		stopConsumer();
+		flushBatch();
+		m_bStarted.store( false );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::drain */
+	std::size_t drain( std::size_t nMaxEvents = 0 )
+	{
+		if ( m_deliveryMode != DeliverPolled )
+			return 0;
+
+		std::size_t nEvents = deliverQueued( nMaxEvents );
+		flushExpiredBatch();
+		return nEvents;
+	}
+
+	/** @copydoc ApplicationPushSinkBase::getLatencyStatistics */
+	void getLatencyStatistics( Facade::SimpleLatencyStats& stats, bool bReset = false )
+	{
+		Measurement::Timestamp now( Measurement::now() );
+		Measurement::Timestamp since( m_latencySince.load( boost::memory_order_relaxed ) );
+
+		stats.count = m_arrivalAge.count();
+		stats.rate = now > since ? stats.count * 1e9 / ( now - since ) : 0.0;
+		stats.ageP50 = m_arrivalAge.percentile( 0.5 );
+		stats.ageP90 = m_arrivalAge.percentile( 0.9 );
+		stats.ageP99 = m_arrivalAge.percentile( 0.99 );
+		stats.ageMax = m_arrivalAge.max();
+		stats.callbackP50 = m_callbackTime.percentile( 0.5 );
+		stats.callbackP90 = m_callbackTime.percentile( 0.9 );
+		stats.callbackP99 = m_callbackTime.percentile( 0.99 );
+		stats.callbackMax = m_callbackTime.max();
+
+		if ( bReset )
+		{
+			m_arrivalAge.reset();
+			m_callbackTime.reset();
+			m_latencySince.store( now, boost::memory_order_relaxed );
+		}
+	}
+
+	/** @copydoc ApplicationPushSinkBase::setDeliveryPolicy */
+	void setDeliveryPolicy( DeliveryPolicy policy )
+	{
+		// pushHandler reads the mode, policy and queue without synchronization, and no consumer runs for a new queue
+		if ( m_bStarted.load() )
+			UBITRACK_THROW( "Component " + getName() + " is running, the delivery policy can only be changed before it is started" );
+
+		if ( policy == PolicyLatest && m_deliveryMode == DeliverSynchronous )
+			m_deliveryMode = DeliverQueued;
+
+		// keep the queue, it may still hold events from the fifo policy
+		if ( m_deliveryMode != DeliverSynchronous && !m_pQueue )
+			m_pQueue.reset( new QueueType( m_nQueueCapacity ) );
+
+		m_deliveryPolicy = policy;
+	}
+
+	/** @copydoc ApplicationPushSinkBase::setExecutor */
+	void setExecutor( ApplicationPushSinkExecutor* pExecutor )
+	{
+		// the queue supports a single consumer, keep the consumer thread if already started
+		// or if it has to flush a batch window
+		if ( !m_pConsumerThread && !m_nBatchMaxDelay )
+			m_pExecutor = pExecutor;
+	}
+
+	/** @copydoc ApplicationPushSinkBase::runExecutorTask */
+	void runExecutorTask()
+	{
+		try
+		{
+			deliverQueued( s_nExecutorTaskEvents );
+			flushExpiredBatch();
+		}
+		catch ( ... )
+		{
+			// the events behind the failed callback must not wait for the next push
+			finishExecutorTask();
+			throw;
+		}
+		finishExecutorTask();
+	}
+
+	/** @copydoc ApplicationPushSinkBase::getStatistics */
+	void getStatistics( Facade::SimplePushSinkStats& stats ) const
+	{
+		stats.received = m_nReceived.load( boost::memory_order_relaxed );
+		stats.delivered = m_nDelivered.load( boost::memory_order_relaxed );
+		stats.overruns = m_nOverruns.load( boost::memory_order_relaxed );
+		stats.conflated = m_nConflated.load( boost::memory_order_relaxed );
+	}
+
+	/** @copydoc ApplicationPushSinkBase::createLatestValueSlot */
+	boost::shared_ptr< SeqlockSlotBase > createLatestValueSlot() const
+	{
+		return LatestValuePublisherType::create();
+	}
+
+	/** @copydoc ApplicationPushSinkBase::setLatestValueSlot */
+	void setLatestValueSlot( boost::shared_ptr< SeqlockSlotBase > pSlot )
+	{
+		typename LatestValuePublisherType::SlotType* pTyped( 0 );
+		if ( pSlot )
+		{
+			pTyped = LatestValuePublisherType::cast( pSlot.get() );
+			if ( !pTyped )
+				UBITRACK_THROW( "Latest value slot does not match the type of component " + getName() );
+		}
+
+		// slots are kept until the sink is destroyed, so a push running concurrently can still use the old one
+		boost::mutex::scoped_lock lock( m_latestValueMutex );
+		if ( pSlot && ( m_latestValueSlots.empty() || m_latestValueSlots.back() != pSlot ) )
+			m_latestValueSlots.push_back( pSlot );
+		m_pLatestValueSlot.store( pTyped, boost::memory_order_release );
 	}
 
 protected:
+	/** type of the hand-off queue */
+	typedef boost::lockfree::spsc_queue< EventType > QueueType;
+
+	/** maximum number of events delivered by one executor task, so that other sinks get their turn */
+	static const std::size_t s_nExecutorTaskEvents = 64;
+
+	/** a consumer of single events, exactly one of the members is set */
+	struct Subscriber
+	{
+		Subscriber()
+			: nHandle( 0 )
+			, pReceiver( 0 )
+			, pBinaryReceiver( 0 )
+			, pStringReceiver( 0 )
+		{}
+
+		bool empty() const
+		{ return !callback && !pReceiver && !pBinaryReceiver && !pStringReceiver; }
+
+		unsigned int nHandle;
+		typename PushConsumer< EventType >::SlotType callback;
+		ReceiverType* pReceiver;
+		Facade::SimpleBinaryReceiver* pBinaryReceiver;
+		Facade::SimpleStringReceiver* pStringReceiver;
+	};
+
+	/** list of subscribers and the conversions they need */
+	struct SubscriberList
+	{
+		SubscriberList()
+			: bSimple( false )
+			, bBinary( false )
+			, bString( false )
+		{}
+
+		void add( const Subscriber& subscriber )
+		{
+			subscribers.push_back( subscriber );
+			bSimple = bSimple || subscriber.pReceiver;
+			bBinary = bBinary || subscriber.pBinaryReceiver;
+			bString = bString || subscriber.pStringReceiver;
+		}
+
+		std::vector< Subscriber > subscribers;
+		bool bSimple;
+		bool bBinary;
+		bool bString;
+	};
+
+	/**
+	 * Registers a delivery as reader of the subscriber list for its lifetime. The guards of
+	 * a thread form a stack in thread-specific storage, so that changes of the subscribers
+	 * can tell whether they are made from within a delivery of the same sink.
+	 */
+	class SubscriberReadGuard
+	{
+	public:
+		SubscriberReadGuard( ApplicationPushSink& sink )
+			: m_sink( sink )
+			, m_pPrevious( stack().get() )
+		{
+			m_sink.m_nSubscriberReaders.fetch_add( 1 );
+			stack().reset( this );
+		}
+
+		~SubscriberReadGuard()
+		{
+			stack().reset( m_pPrevious );
+			m_sink.m_nSubscriberReaders.fetch_sub( 1 );
+		}
+
+		/** true if the calling thread is delivering events of \p sink */
+		static bool delivering( const ApplicationPushSink& sink )
+		{
+			for ( const SubscriberReadGuard* p = stack().get(); p; p = p->m_pPrevious )
+				if ( &p->m_sink == &sink )
+					return true;
+			return false;
+		}
+
+	protected:
+		/** the guards live on the stack, nothing to delete */
+		static void keep( SubscriberReadGuard* )
+		{}
+
+		static boost::thread_specific_ptr< SubscriberReadGuard >& stack()
+		{
+			static boost::thread_specific_ptr< SubscriberReadGuard > s_stack( &keep );
+			return s_stack;
+		}
+
+		ApplicationPushSink& m_sink;
+		SubscriberReadGuard* m_pPrevious;
+	};
+
 	/**
 	 * Handler method for push consumer
 	 * This is the handler method for the input port.
@@ -155,32 +817,512 @@ protected:
 	 */
 	void pushHandler( const EventType& m )
 	{
-#ifndef APPLICATIONPUSHSINK_NOLOGGING
-		LOG4CPP_DEBUG( m_logger, getName() << " received event" );
-#endif
+		UTFACADE_TRACE( PushSink, "received event", getName().c_str(), m.time() );
+		m_nReceived.fetch_add( 1, boost::memory_order_relaxed );
 
-		if( m_callback )
-			m_callback( m );
-#ifndef APPLICATIONPUSHSINK_NOLOGGING
+		Measurement::Timestamp now( Measurement::now() );
+		m_arrivalAge.add( now > m.time() ? now - m.time() : 0 );
+
+		if ( typename LatestValuePublisherType::SlotType* pSlot = m_pLatestValueSlot.load( boost::memory_order_acquire ) )
+			LatestValuePublisherType::publish( pSlot, m );
+
+		if ( m_deliveryMode == DeliverSynchronous )
+		{
+			deliver( m );
+			return;
+		}
+
+		if ( m_deliveryPolicy == PolicyLatest )
+		{
+			boost::mutex::scoped_lock lock( m_latestMutex );
+			if ( m_bHaveLatest.load( boost::memory_order_relaxed ) )
+				m_nConflated.fetch_add( 1, boost::memory_order_relaxed );
+			m_latest = m;
+			m_bHaveLatest.store( true, boost::memory_order_release );
+		}
+		else if ( !m_pQueue->push( m ) )
+		{
+			m_nOverruns.fetch_add( 1, boost::memory_order_relaxed );
+			return;
+		}
+
+		if ( m_deliveryMode == DeliverExecutor && m_pExecutor )
+		{
+			scheduleExecutorTask();
+			return;
+		}
+
+		// only take the lock if the consumer thread is about to sleep
+		boost::atomic_thread_fence( boost::memory_order_seq_cst );
+		if ( m_bConsumerWaiting.load( boost::memory_order_relaxed ) )
+		{
+			boost::mutex::scoped_lock lock( m_wakeMutex );
+			m_wakeCondition.notify_one();
+		}
+	}
+
+	/** calls the subscribers for a single event or adds it to the current batch */
+	void deliver( const EventType& m )
+	{
+		SubscriberReadGuard guard( *this );
+		const SubscriberList* pSubscribers = m_pSubscribers.load();
+		if ( pSubscribers )
+		{
+			deliverToSubscribers( *pSubscribers, m );
+			return;
+		}
+
+		if ( m_bBatchActive.load() )
+		{
+			if ( m_batch.empty() )
+				m_batchStart = Measurement::now();
+			m_batch.push_back( m );
+
+			if ( m_batch.size() >= m_nBatchMaxEvents )
+				flushBatch();
+			else
+				flushExpiredBatch();
+		}
 		else
-			LOG4CPP_INFO( m_logger, "ApplicationPushSink " << getName() << " has no consumer connected" );
-#endif
+			UTFACADE_TRACE( PushSink, "no consumer connected", getName().c_str(), m.time() );
+	}
+
+	/** converts the event once for each representation needed and passes it to all subscribers */
+	void deliverToSubscribers( const SubscriberList& list, const EventType& m )
+	{
+		Measurement::Timestamp start( Measurement::now() );
+
+		if ( list.bSimple )
+		{
+			UTFACADE_TRACE( Converter, "convert for receivers", getName().c_str(), m.time() );
+			ConverterType::convert( m, m_simple );
+		}
+		if ( list.bBinary )
+			Facade::BinaryCodec< EventType >::encode( m, m_binary );
+		if ( list.bString )
+		{
+			Util::SimpleStringOArchive ar;
+			ar << m;
+			m_string = ar.str();
+		}
+
+		for ( typename std::vector< Subscriber >::const_iterator it = list.subscribers.begin(); it != list.subscribers.end(); ++it )
+		{
+			if ( it->pReceiver )
+				ConverterType::dispatch( it->pReceiver, m_simple );
+			else if ( it->pBinaryReceiver )
+				it->pBinaryReceiver->receiveBinary( &m_binary[ 0 ], m_binary.size() );
+			else if ( it->pStringReceiver )
+				it->pStringReceiver->receiveString( m_string.c_str() );
+			else
+				it->callback( m );
+		}
+
+		addCallbackTime( start );
+		m_nDelivered.fetch_add( 1, boost::memory_order_relaxed );
 	}
 
-	/** converts events to string */
-	static void sendString( const EventType& m, Facade::SimpleStringReceiver* pReceiver )
+	/** passes the collected events to the batch callback or receiver */
+	void flushBatch()
 	{
-		Util::SimpleStringOArchive ar;
-		ar << m;
-		std::string s( ar.str() );
-		pReceiver->receiveString( s.c_str() );
+		SubscriberReadGuard guard( *this );
+		if ( m_batch.empty() || !m_bBatchActive.load() )
+			return;
+
+		Measurement::Timestamp start( Measurement::now() );
+		if ( m_pBatchReceiver )
+		{
+			const std::size_t nEvents = m_batch.size();
+			m_simpleBatch.resize( nEvents );
+			for ( std::size_t i = 0; i < nEvents; i++ )
+				ConverterType::convert( m_batch[ i ], m_simpleBatch[ i ] );
+			ConverterType::dispatchBatch( m_pBatchReceiver, &m_simpleBatch[ 0 ], nEvents );
+		}
+		else
+			m_batchCallback( &m_batch[ 0 ], m_batch.size() );
+		addCallbackTime( start );
+		m_nDelivered.fetch_add( m_batch.size(), boost::memory_order_relaxed );
+
+		// keeps the capacity
+		m_batch.clear();
+	}
+
+	/** removes all callbacks and receivers */
+	void clearConsumers()
+	{
+		replaceSubscribers( Subscriber() );
+	}
+
+	/** replaces all consumers by a single subscriber, or none if \p subscriber is empty */
+	void replaceSubscribers( Subscriber subscriber )
+	{
+		boost::mutex::scoped_lock lock( m_subscriberMutex );
+		m_bBatchActive.store( false );
+
+		SubscriberList* pNew = 0;
+		if ( !subscriber.empty() )
+		{
+			pNew = new SubscriberList;
+			subscriber.nHandle = nextSubscriberHandle();
+			pNew->add( subscriber );
+		}
+		publishSubscribers( pNew );
+		waitForSubscriberReaders();
+		releaseBatchConsumers();
+	}
+
+	/**
+	 * Forgets the batch callback and receiver after \c m_bBatchActive was cleared and the
+	 * deliveries have left. Inside a delivery of this sink the batch callback may be running,
+	 * so it is kept until the next setBatchCallback. \c m_subscriberMutex must be locked.
+	 */
+	void releaseBatchConsumers()
+	{
+		if ( SubscriberReadGuard::delivering( *this ) )
+			return;
+
+		m_batchCallback = 0;
+		m_pBatchReceiver = 0;
+	}
+
+	/** adds a subscriber to a copy of the current list and publishes it */
+	unsigned int addSubscriber( Subscriber subscriber )
+	{
+		if ( subscriber.empty() )
+			return 0;
+
+		boost::mutex::scoped_lock lock( m_subscriberMutex );
+		const SubscriberList* pOld = m_pSubscribers.load();
+		SubscriberList* pNew = pOld ? new SubscriberList( *pOld ) : new SubscriberList;
+		subscriber.nHandle = nextSubscriberHandle();
+		pNew->add( subscriber );
+		publishSubscribers( pNew );
+		return subscriber.nHandle;
+	}
+
+	/** returns a new subscriber handle, never 0. \c m_subscriberMutex must be locked. */
+	unsigned int nextSubscriberHandle()
+	{
+		unsigned int nHandle = m_nNextSubscriber++;
+		if ( m_nNextSubscriber == 0 )
+			m_nNextSubscriber = 1;
+		return nHandle;
 	}
-	
+
+	/**
+	 * Replaces the subscriber list. The old list is retired and deleted as soon as no delivery
+	 * is running. A delivery that loaded the old list has registered as reader before loading
+	 * it, so if no reader is active after the new list was published, nobody can use the old one.
+	 * \c m_subscriberMutex must be locked.
+	 */
+	void publishSubscribers( SubscriberList* pNew )
+	{
+		SubscriberList* pOld = m_pSubscribers.exchange( pNew );
+		if ( pOld )
+			m_retiredSubscribers.push_back( pOld );
+
+		if ( m_nSubscriberReaders.load() == 0 )
+			deleteRetiredSubscribers();
+	}
+
+	/**
+	 * Waits until no delivery is running and deletes the retired lists, so the removed
+	 * consumers are not called any more. Returns at once if called from a delivery of this
+	 * sink, which would otherwise wait for itself. \c m_subscriberMutex must be locked.
+	 */
+	void waitForSubscriberReaders()
+	{
+		if ( SubscriberReadGuard::delivering( *this ) )
+			return;
+
+		for ( unsigned int nSpins = 0; m_nSubscriberReaders.load() != 0; nSpins++ )
+		{
+			if ( nSpins < 100 )
+				boost::this_thread::yield();
+			else
+				boost::this_thread::sleep( boost::posix_time::microseconds( 100 ) );
+		}
+		deleteRetiredSubscribers();
+	}
+
+	/** deletes the retired subscriber lists. \c m_subscriberMutex must be locked. */
+	void deleteRetiredSubscribers()
+	{
+		for ( std::size_t i = 0; i < m_retiredSubscribers.size(); i++ )
+			delete m_retiredSubscribers[ i ];
+		m_retiredSubscribers.clear();
+	}
+
+	/** throws if the event type has no binary encoding */
+	void checkBinarySupport()
+	{
+		if ( !Facade::BinaryCodec< EventType >::s_bSupported )
+			UBITRACK_THROW( "Component " + getName() + " does not support binary callbacks" );
+	}
+
+	/** throws if a batch window of \p nMaxDelayUs could not be kept in the current delivery mode */
+	void checkBatchWindow( unsigned long long nMaxDelayUs ) const
+	{
+		if ( nMaxDelayUs == 0 )
+			return;
+
+		if ( m_deliveryMode == DeliverSynchronous )
+			UBITRACK_THROW( "Component " + getName() + " delivers synchronously, a batch window requires queued, polled or executor mode" );
+		if ( m_deliveryMode == DeliverExecutor && m_pExecutor )
+			UBITRACK_THROW( "Component " + getName() + " delivers on the callback executor, which does not support a batch window" );
+	}
+
+	/** sets the batch limits and clears the current batch */
+	void configureBatch( std::size_t nMaxEvents, unsigned long long nMaxDelayUs )
+	{
+		m_batch.clear();
+		m_nBatchMaxEvents = nMaxEvents > 0 ? nMaxEvents : 1;
+		m_batch.reserve( m_nBatchMaxEvents );
+		m_nBatchMaxDelay = nMaxDelayUs * 1000;
+	}
+
+	/** records the duration of a callback that started at \p start */
+	void addCallbackTime( Measurement::Timestamp start )
+	{
+		Measurement::Timestamp end( Measurement::now() );
+		m_callbackTime.add( end > start ? end - start : 0 );
+	}
+
+	/** flushes the batch if its first event has waited longer than the batch window */
+	void flushExpiredBatch()
+	{
+		if ( m_nBatchMaxDelay && !m_batch.empty() && Measurement::now() - m_batchStart >= m_nBatchMaxDelay )
+			flushBatch();
+	}
+
+	/**
+	 * Delivers events from the hand-off queue. Must only be called by the single consumer.
+	 * @param nMaxEvents maximum number of events to deliver, 0 for all
+	 * @return number of events taken from the queue
+	 */
+	std::size_t deliverQueued( std::size_t nMaxEvents )
+	{
+		std::size_t nEvents = 0;
+		// pop before delivering, consume_one would keep an event whose callback throws in the queue
+		EventType m;
+		while ( ( nMaxEvents == 0 || nEvents < nMaxEvents ) && m_pQueue->pop( m ) )
+		{
+			nEvents++;
+			deliver( m );
+		}
+
+		if ( ( nMaxEvents == 0 || nEvents < nMaxEvents ) && takeLatest( m ) )
+		{
+			nEvents++;
+			deliver( m );
+		}
+		return nEvents;
+	}
+
+	/** takes the event from the conflation slot, if any */
+	bool takeLatest( EventType& m )
+	{
+		if ( !m_bHaveLatest.load( boost::memory_order_acquire ) )
+			return false;
+
+		boost::mutex::scoped_lock lock( m_latestMutex );
+		if ( !m_bHaveLatest.load( boost::memory_order_relaxed ) )
+			return false;
+		m = m_latest;
+		// do not keep a reference to the event
+		m_latest = EventType();
+		m_bHaveLatest.store( false, boost::memory_order_relaxed );
+		return true;
+	}
+
+	/** checks if events are waiting in the queue or the conflation slot */
+	bool hasPendingEvents() const
+	{
+		return m_pQueue->read_available() || m_bHaveLatest.load( boost::memory_order_acquire );
+	}
+
+	/** main loop of the consumer thread in \c queued mode */
+	void consumerThread()
+	{
+		while ( !m_bStopConsumer.load() )
+		{
+			if ( deliverQueued( 0 ) )
+				continue;
+
+			flushExpiredBatch();
+
+			boost::mutex::scoped_lock lock( m_wakeMutex );
+			m_bConsumerWaiting.store( true );
+			boost::atomic_thread_fence( boost::memory_order_seq_cst );
+			if ( !m_bStopConsumer.load() && !hasPendingEvents() )
+				m_wakeCondition.timed_wait( lock, boost::posix_time::milliseconds( m_nBatchMaxDelay ? 1 : 100 ) );
+			m_bConsumerWaiting.store( false );
+		}
+	}
+
+	/** ends the running executor task and schedules a new one if events are pending */
+	void finishExecutorTask()
+	{
+		// events pushed after this point see the flag cleared and schedule a new task
+		m_bTaskScheduled.store( false );
+		boost::atomic_thread_fence( boost::memory_order_seq_cst );
+		if ( hasPendingEvents() )
+			scheduleExecutorTask();
+	}
+
+	/** hands a task to the executor, unless one is already scheduled */
+	void scheduleExecutorTask()
+	{
+		if ( !m_bTaskScheduled.exchange( true ) )
+			m_pExecutor->schedule( this );
+	}
+
+	/**
+	 * Stops and joins the consumer thread, or waits for the executor task to finish.
+	 * Called from a callback of this sink, it only tells the consumer thread to exit
+	 * and does not wait, as the thread or task running the callback cannot wait for itself.
+	 */
+	void stopConsumer()
+	{
+		const bool bOwnCallback = SubscriberReadGuard::delivering( *this );
+		while ( !bOwnCallback && m_bTaskScheduled.load() )
+			boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+
+		if ( !m_pConsumerThread )
+			return;
+
+		{
+			boost::mutex::scoped_lock lock( m_wakeMutex );
+			m_bStopConsumer.store( true );
+			m_wakeCondition.notify_one();
+		}
+		if ( bOwnCallback )
+			return;
+
+		m_pConsumerThread->join();
+		m_pConsumerThread.reset();
+	}
+
 	/** Input port of the function. */
 	PushConsumer< EventType > m_InPort;
 
-	/** Type of the callback functions */
-	typename PushConsumer< EventType >::SlotType m_callback;
+	/** current subscribers, NULL if there are none. The list is never modified after publishing. */
+	boost::atomic< SubscriberList* > m_pSubscribers;
+
+	/** number of deliveries that may be reading the subscriber list */
+	boost::atomic< unsigned int > m_nSubscriberReaders;
+
+	/** replaced subscriber lists that may still be read by a delivery */
+	std::vector< SubscriberList* > m_retiredSubscribers;
+
+	/** serializes changes of the subscriber list */
+	boost::mutex m_subscriberMutex;
+
+	/** handle of the next subscriber */
+	unsigned int m_nNextSubscriber;
+
+	/** events converted for the receivers, reused to avoid allocations */
+	SimpleType m_simple;
+
+	/** events encoded for the binary receivers, reused to avoid allocations */
+	std::vector< unsigned char > m_binary;
+
+	/** events serialized for the string receivers */
+	std::string m_string;
+
+	/** batch callback, used if no per-event callback is set */
+	BatchSlotType m_batchCallback;
+
+	/** batch receiver for the simple datatype */
+	BatchReceiverType* m_pBatchReceiver;
+
+	/**
+	 * set while a batch callback or receiver is installed. Deliveries only use them while
+	 * it is set, and they are only changed after it was cleared and the readers have left.
+	 */
+	boost::atomic< bool > m_bBatchActive;
+
+	/** collected events converted for the batch receiver */
+	std::vector< SimpleType > m_simpleBatch;
+
+	/** events collected for the batch callback */
+	std::vector< EventType > m_batch;
+
+	/** maximum number of events per batch */
+	std::size_t m_nBatchMaxEvents;
+
+	/** maximum time in ns an event waits in the batch, 0 for unlimited */
+	unsigned long long m_nBatchMaxDelay;
+
+	/** arrival time of the first event in the batch */
+	unsigned long long m_batchStart;
+
+	/** how events are handed to the application */
+	DeliveryMode m_deliveryMode;
+
+	/** which events are handed to the application */
+	DeliveryPolicy m_deliveryPolicy;
+
+	/** capacity of the hand-off queue */
+	std::size_t m_nQueueCapacity;
+
+	/** hand-off queue in \c queued and \c polled mode */
+	boost::scoped_ptr< QueueType > m_pQueue;
+
+	/** conflation slot for the \c latest policy, protected by \c m_latestMutex */
+	EventType m_latest;
+	boost::atomic< bool > m_bHaveLatest;
+	boost::mutex m_latestMutex;
+
+	/** number of events received from the dataflow */
+	boost::atomic< unsigned long long > m_nReceived;
+
+	/** number of events passed to the callback */
+	boost::atomic< unsigned long long > m_nDelivered;
+
+	/** number of events dropped because the queue was full */
+	boost::atomic< unsigned long long > m_nOverruns;
+
+	/** number of events replaced by a newer event in the conflation slot */
+	boost::atomic< unsigned long long > m_nConflated;
+
+	/** age of events on arrival in ns */
+	LatencyHistogram m_arrivalAge;
+
+	/** duration of application callbacks in ns */
+	LatencyHistogram m_callbackTime;
+
+	/** start of the current latency measurement period */
+	boost::atomic< Measurement::Timestamp > m_latencySince;
+
+	/** set between start and stop */
+	boost::atomic< bool > m_bStarted;
+
+	/** set by the consumer thread before it goes to sleep */
+	boost::atomic< bool > m_bConsumerWaiting;
+
+	/** tells the consumer thread to exit */
+	boost::atomic< bool > m_bStopConsumer;
+
+	/** mutex and condition used to wake up the sleeping consumer thread */
+	boost::mutex m_wakeMutex;
+	boost::condition_variable m_wakeCondition;
+
+	/** consumer thread in \c queued mode */
+	boost::scoped_ptr< boost::thread > m_pConsumerThread;
+
+	/** executor running the callbacks in \c executor mode */
+	ApplicationPushSinkExecutor* m_pExecutor;
+
+	/** is a task of this sink waiting in or running on the executor? */
+	boost::atomic< bool > m_bTaskScheduled;
+
+	/** slot receiving the latest converted value, if set */
+	boost::atomic< typename LatestValuePublisherType::SlotType* > m_pLatestValueSlot;
+
+	/** keeps all slots that were ever set alive, protected by \c m_latestValueMutex */
+	std::vector< boost::shared_ptr< SeqlockSlotBase > > m_latestValueSlots;
+	boost::mutex m_latestValueMutex;
 
 #ifndef APPLICATIONPUSHSINK_NOLOGGING
 	/** reference to logger */
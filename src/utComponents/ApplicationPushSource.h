@@ -38,12 +38,21 @@
 #include <iostream>
 
 #include <boost/bind.hpp>
+#include <boost/atomic.hpp>
 
 #include <utDataflow/PushSupplier.h>
 #include <utDataflow/Component.h>
 #include <utMeasurement/Measurement.h>
+#include <utUtil/Exception.h>
+#include <utGraph/UTQLSubgraph.h>
 #include <utFacade/SimpleDatatypes.h>
+#include <utFacade/Trace.h>
+#include <utFacade/Clock.h>
+#include <utFacade/BinaryCodec.h>
+#include <utFacade/TextParser.h>
 #include <utUtil/SimpleStringIArchive.h>
+#include <utUtil/SimpleStringOArchive.h>
+#include <utComponents/PushAdmission.h>
 
 #include <log4cpp/Category.hh>
 
@@ -58,6 +67,21 @@ namespace Ubitrack { namespace Components {
 
 using namespace Dataflow;
 
+/**
+ * Non-template interface of all \c ApplicationPushSource components, used by the facade
+ * to query statistics without knowing the event type.
+ */
+class ApplicationPushSourceBase
+{
+public:
+	virtual ~ApplicationPushSourceBase()
+	{}
+
+	/** returns the parse and admission statistics */
+	virtual void getStatistics( Facade::SimplePushSourceStats& stats ) const = 0;
+};
+
+
 /**
  * @ingroup dataflow_components
  * This is an source component which may be used to interface
@@ -67,6 +91,22 @@ using namespace Dataflow;
  * function to the application that can be used to send
  * events into the dataflow network.
  *
+ * Events can also be sent as strings via \c receiveString or in
+ * the binary encoding of \c Facade::BinaryCodec via \c receiveBinary.
+ * Strings are read by \c Facade::TextParser, which allocates only the measurement. The first
+ * string is also read with \c Util::SimpleStringIArchive and the parser is only used
+ * if both agree; strings the parser does not accept fall back to the archive.
+ * Events that cannot be decoded are logged and counted, see \c getStatistics.
+ *
+ * All events pass an admission policy (see \c PushAdmission) before they reach the
+ * output port, which protects the dataflow from an application that sends bursts.
+ *
+ * The specializations for poses, positions and buttons also implement the batch
+ * receiver interfaces, which send an array of events in one call. The events are
+ * passed to the output port in array order with their own timestamps, so a batch
+ * behaves exactly like the same events sent one by one, but costs a single call
+ * through the language binding.
+ *
  * @par Input Ports
  * None.
  *
@@ -74,12 +114,17 @@ using namespace Dataflow;
  * PushSupplier<EventType> port with name "Output".
  *
  * @par Configuration
- * None.
+ * - \c admission: "all" (default), "maxRate", "coalesce" or "dropOldest"
+ * - \c maxRate: events per second for "maxRate" and "dropOldest"
+ * - \c coalesceMs: window for "coalesce" in milliseconds
+ * - \c maxBacklog: backlog size for "dropOldest", default 16
  */
 template< class EventType >
 class ApplicationPushSource 
 	: public Component
+	, public ApplicationPushSourceBase
 	, public Facade::SimpleStringReceiver
+	, public Facade::SimpleBinaryReceiver
 {
 public:
 	// type of callback
@@ -89,20 +134,33 @@ public:
 	 * Standard component constructor.
 	 *
 	 * @param nm Unique name of the component.
-	 * @param cfg ComponentConfiguration containing all configuration.
+	 * @param pConfig ComponentConfiguration containing all configuration.
 	 */
-	ApplicationPushSource( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph >  )
+	ApplicationPushSource( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph > pConfig )
 		: Ubitrack::Dataflow::Component( nm )
 		, m_outPort( "Output", *this )
+		, m_nParseErrors( 0 )
+		, m_nFastParsed( 0 )
+		, m_nArchiveParsed( 0 )
+		, m_textMode( textUnvalidated )
+	{
+		m_admission.setSend( boost::bind( &PushSupplier< EventType >::send, &m_outPort, _1 ) );
+		if ( pConfig )
+			m_admission.configure( nm, *pConfig );
+	}
+
+	/** stops the admission worker, if any, before the port goes away */
+	~ApplicationPushSource()
 	{
+		m_admission.stop();
 	}
 
 	/**
-	 * Sends an event.
+	 * Sends an event through the admission policy.
 	 * @param evt the event to send
 	 */
 	void send( const EventType& evt )
-	{ m_outPort.send( evt ); }
+	{ m_admission.push( evt ); }
 	
 	/**
 	 * Get the callback.
@@ -111,7 +169,21 @@ public:
 	 * @return callback function for the user application.
 	 */
 	CallbackType getCallback ()
-	{ return boost::bind( &PushSupplier< EventType >::send, &m_outPort, _1 ); }
+	{ return boost::bind( &ApplicationPushSource::send, this, _1 ); }
+
+	/** starts the admission worker, if the policy needs one */
+	virtual void start()
+	{
+		m_admission.start();
+		Component::start();
+	}
+
+	/** stops the admission worker, dropping held events */
+	virtual void stop()
+	{
+		Component::stop();
+		m_admission.stop();
+	}
 
 	/**
 	 * Method to call to send stringified data.
@@ -121,26 +193,129 @@ public:
 	{
 		try
 		{
-			// read from string
-			Util::SimpleStringIArchive ar( s );
-			EventType e( boost::shared_ptr< typename EventType::value_type >( new typename EventType::value_type() ) );
-			ar >> e;
-			
+			EventType e;
+			int mode = m_textMode.load( boost::memory_order_relaxed );
+			if ( mode != textArchive && Facade::TextParser< EventType >::parse( s, e ) )
+			{
+				if ( mode == textUnvalidated )
+					validateTextParser( s, e );
+				else
+					m_nFastParsed.fetch_add( 1, boost::memory_order_relaxed );
+			}
+			else
+				parseArchive( s, e );
+
 			// add timestamp if necessary
 			if ( !e.time() )
-				e = EventType( Measurement::now(), e );
+				e = EventType( Facade::Clock::now(), e );
 			
-			m_outPort.send( e );
+			send( e );
+		}
+		catch ( const std::exception& e )
+		{
+			m_nParseErrors.fetch_add( 1, boost::memory_order_relaxed );
+			LOG4CPP_WARN( log4cpp::Category::getInstance( "Ubitrack.Components.ApplicationPushSource" ),
+				"Dropping string event in " << getName() << ": " << e.what() );
+		}
+		catch( ... )
+		{
+			m_nParseErrors.fetch_add( 1, boost::memory_order_relaxed );
+		}
+	}
+
+	/**
+	 * Method to call to send binary data, see \c Facade::BinaryCodec for the format.
+	 * Invalid data is logged and dropped.
+	 */
+	void receiveBinary( const void* pData, size_t nBytes ) throw()
+	{
+		try
+		{
+			EventType e;
+			Facade::BinaryCodec< EventType >::decode( pData, nBytes, e );
+
+			// add timestamp if necessary
+			if ( !e.time() )
+				e = EventType( Facade::Clock::now(), e );
+
+			send( e );
+		}
+		catch ( const Util::Exception& e )
+		{
+			m_nParseErrors.fetch_add( 1, boost::memory_order_relaxed );
+			LOG4CPP_WARN( log4cpp::Category::getInstance( "Ubitrack.Components.ApplicationPushSource" ),
+				"Dropping binary event in " << getName() << ": " << e.what() );
 		}
-		catch ( const std::runtime_error& )
-		{}
 		catch( ... )
-		{}
+		{
+			m_nParseErrors.fetch_add( 1, boost::memory_order_relaxed );
+		}
+	}
+
+	/** returns the parse and admission statistics */
+	void getStatistics( Facade::SimplePushSourceStats& stats ) const
+	{
+		stats.parseErrors = m_nParseErrors.load( boost::memory_order_relaxed );
+		stats.fastParsed = m_nFastParsed.load( boost::memory_order_relaxed );
+		stats.archiveParsed = m_nArchiveParsed.load( boost::memory_order_relaxed );
+		stats.admitted = m_admission.admitted();
+		stats.coalesced = m_admission.coalesced();
+		stats.dropped = m_admission.dropped();
 	}
 	
 protected:
+
+	/** state of the text parser: not yet compared with the archive, in use or disabled */
+	enum TextMode { textUnvalidated, textFast, textArchive };
+
+	/** reads a string with \c Util::SimpleStringIArchive, throws on error */
+	void parseArchive( const char* s, EventType& e )
+	{
+		Util::SimpleStringIArchive ar( s );
+		e = EventType( boost::shared_ptr< typename EventType::value_type >( new typename EventType::value_type() ) );
+		ar >> e;
+		m_nArchiveParsed.fetch_add( 1, boost::memory_order_relaxed );
+	}
+
+	/**
+	 * Compares the result of the text parser for the first string with the archive.
+	 * If they differ, the parser is disabled and \p e is replaced by the archive result.
+	 */
+	void validateTextParser( const char* s, EventType& e )
+	{
+		EventType reference;
+		parseArchive( s, reference );
+
+		Util::SimpleStringOArchive fast;
+		fast << e;
+		Util::SimpleStringOArchive archive;
+		archive << reference;
+
+		if ( fast.str() == archive.str() )
+		{
+			m_textMode.store( textFast, boost::memory_order_relaxed );
+			return;
+		}
+
+		LOG4CPP_WARN( log4cpp::Category::getInstance( "Ubitrack.Components.ApplicationPushSource" ),
+			"Text parser disagrees with the archive in " << getName() << ", using the archive for all strings" );
+		m_textMode.store( textArchive, boost::memory_order_relaxed );
+		e = reference;
+	}
+
 	/** Input port of the function. */
 	PushSupplier< EventType > m_outPort;
+
+	/** admission policy in front of the port */
+	PushAdmission< EventType > m_admission;
+
+	/** parse statistics */
+	boost::atomic< unsigned long long > m_nParseErrors;
+	boost::atomic< unsigned long long > m_nFastParsed;
+	boost::atomic< unsigned long long > m_nArchiveParsed;
+
+	/** a TextMode */
+	boost::atomic< int > m_textMode;
 };
 
 typedef ApplicationPushSource< Measurement::Rotation > ApplicationPushSourceRotation;
@@ -157,6 +332,7 @@ typedef ApplicationPushSource< Measurement::PoseList > ApplicationPushSourcePose
 class ApplicationPushSourcePose
 	: public ApplicationPushSource< Measurement::Pose >
     , public Facade::SimplePoseReceiver
+    , public Facade::SimplePoseBatchReceiver
 {
 public:
 	/**
@@ -171,9 +347,23 @@ public:
 
 	/** implements the \c Facade::SimplePoseReceiver interface */
 	void receivePose( const Facade::SimplePose& pose ) throw()
+	{
+		sendPose( pose );
+	}
+
+	/** implements the \c Facade::SimplePoseBatchReceiver interface */
+	void receivePoses( const Facade::SimplePose* poses, size_t count ) throw()
+	{
+		UTFACADE_TRACE1( PushSource, "receivePoses", getName().c_str(), count ? poses[ 0 ].timestamp : 0, static_cast< double >( count ) );
+		for ( size_t i = 0; i < count; i++ )
+			sendPose( poses[ i ] );
+	}
+
+protected:
+	void sendPose( const Facade::SimplePose& pose )
 	{
 		// convert SimplePose to Measurement::Pose
-		m_outPort.send( Measurement::Pose( pose.timestamp,
+		send( Measurement::Pose( pose.timestamp,
 			Math::Pose(
 				Math::Quaternion( pose.rx, pose.ry, pose.rz, pose.rw ),
 				Math::Vector< double, 3 >( pose.tx, pose.ty, pose.tz )
@@ -190,6 +380,7 @@ public:
 class ApplicationPushSourcePosition2D
 	: public ApplicationPushSource< Measurement::Position2D >
     , public Facade::SimplePosition2DReceiver
+    , public Facade::SimplePosition2DBatchReceiver
 {
 public:
 	/**
@@ -207,10 +398,19 @@ public:
 	void receivePosition2D( const Facade::SimplePosition2D& position2d ) throw()
 	{
 		// convert SimplePosition2D to Measurement::Position2D
-		m_outPort.send( Measurement::Position2D( position2d.timestamp,
+		send( Measurement::Position2D( position2d.timestamp,
 			Math::Vector< double, 2 >(position2d.x, position2d.y)
 			) );
-		LOG4CPP_INFO( m_logger, "ApplicationPushSourcePosition2D receivePosition2D: x=" << position2d.x << " y=" << position2d.y );
+		UTFACADE_TRACE2( PushSource, "receivePosition2D", getName().c_str(), position2d.timestamp, position2d.x, position2d.y );
+	}
+
+	/** implements the \c Facade::SimplePosition2DBatchReceiver interface */
+	void receivePositions2D( const Facade::SimplePosition2D* positions, size_t count ) throw()
+	{
+		UTFACADE_TRACE1( PushSource, "receivePositions2D", getName().c_str(), count ? positions[ 0 ].timestamp : 0, static_cast< double >( count ) );
+		for ( size_t i = 0; i < count; i++ )
+			send( Measurement::Position2D( positions[ i ].timestamp,
+				Math::Vector< double, 2 >( positions[ i ].x, positions[ i ].y ) ) );
 	}
 
 	/** reference to logger */
@@ -220,6 +420,7 @@ public:
 class ApplicationPushSourcePosition
 	: public ApplicationPushSource< Measurement::Position >
     , public Facade::SimplePosition3DReceiver
+    , public Facade::SimplePosition3DBatchReceiver
 {
 public:
 	/**
@@ -237,10 +438,19 @@ public:
 	void receivePosition3D( const Facade::SimplePosition3D& position3d ) throw()
 	{
 		// convert SimplePosition2D to Measurement::Position2D
-		m_outPort.send( Measurement::Position( position3d.timestamp,
+		send( Measurement::Position( position3d.timestamp,
 			Math::Vector< double, 3 >(position3d.x, position3d.y, position3d.z)
 			) );
-		LOG4CPP_INFO( m_logger, "ApplicationPushSourcePosition3D receivePosition3D: x=" << position3d.x << " y=" << position3d.y<< " z=" << position3d.z  );
+		UTFACADE_TRACE3( PushSource, "receivePosition3D", getName().c_str(), position3d.timestamp, position3d.x, position3d.y, position3d.z );
+	}
+
+	/** implements the \c Facade::SimplePosition3DBatchReceiver interface */
+	void receivePositions3D( const Facade::SimplePosition3D* positions, size_t count ) throw()
+	{
+		UTFACADE_TRACE1( PushSource, "receivePositions3D", getName().c_str(), count ? positions[ 0 ].timestamp : 0, static_cast< double >( count ) );
+		for ( size_t i = 0; i < count; i++ )
+			send( Measurement::Position( positions[ i ].timestamp,
+				Math::Vector< double, 3 >( positions[ i ].x, positions[ i ].y, positions[ i ].z ) ) );
 	}
 
 	/** reference to logger */
@@ -255,6 +465,7 @@ public:
 class ApplicationPushSourceButton
 	: public ApplicationPushSource< Measurement::Button >
     , public Facade::SimpleButtonReceiver
+    , public Facade::SimpleButtonBatchReceiver
 {
 public:
 	/**
@@ -271,10 +482,18 @@ public:
 	void receiveButton( const Facade::SimpleButton& button ) throw()
 	{
 		// convert SimpleButton to Measurement::Button
-		m_outPort.send( Measurement::Button( button.timestamp,
+		send( Measurement::Button( button.timestamp,
 											 Math::Scalar<int>( button.event ) ) );
 	}
 
+	/** implements the \c Facade::SimpleButtonBatchReceiver interface */
+	void receiveButtons( const Facade::SimpleButton* buttons, size_t count ) throw()
+	{
+		UTFACADE_TRACE1( PushSource, "receiveButtons", getName().c_str(), count ? buttons[ 0 ].timestamp : 0, static_cast< double >( count ) );
+		for ( size_t i = 0; i < count; i++ )
+			send( Measurement::Button( buttons[ i ].timestamp, Math::Scalar< int >( buttons[ i ].event ) ) );
+	}
+
 };
 
 class ApplicationPushSourcePositionList
@@ -303,10 +522,10 @@ public:
 			newValues.push_back(Math::Vector< double, 3 >(values[i].x,values[i].y,values[i].z));
 		}
 		
-		m_outPort.send( Measurement::PositionList( positionlist3d.timestamp,
+		send( Measurement::PositionList( positionlist3d.timestamp,
 			newValues
 			) );
-		LOG4CPP_INFO( m_logger, "ApplicationPushSourcePositionList receivePosition3DList: " );
+		UTFACADE_TRACE1( PushSource, "receivePositionList3D", getName().c_str(), positionlist3d.timestamp, static_cast< double >( values.size() ) );
 	}
 
 	/** reference to logger */
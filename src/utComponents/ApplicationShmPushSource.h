@@ -0,0 +1,465 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Source component that reads events from a shared-memory ring written by another process.
+ */
+#ifndef __UBITRACK_COMPONENTS_APPLICATIONSHMPUSHSOURCE_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_APPLICATIONSHMPUSHSOURCE_H_INCLUDED__
+
+#include <string>
+#include <cstddef>
+#include <time.h>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/static_assert.hpp>
+
+#include <utDataflow/PushSupplier.h>
+#include <utDataflow/Component.h>
+#include <utMeasurement/Measurement.h>
+#include <utUtil/Exception.h>
+#include <utGraph/UTQLSubgraph.h>
+#include <utFacade/SimpleDatatypes.h>
+#include <utFacade/ShmRing.h>
+#include <utFacade/Clock.h>
+#include <utComponents/ApplicationPushSource.h>
+#include <utComponents/PushAdmission.h>
+
+#include <log4cpp/Category.hh>
+
+namespace Ubitrack { namespace Components {
+
+using namespace Dataflow;
+
+// the ring records must have the layout of the simple datatypes
+BOOST_STATIC_ASSERT( sizeof( utshm_pose ) == sizeof( Facade::SimplePose ) );
+BOOST_STATIC_ASSERT( offsetof( utshm_pose, timestamp ) == offsetof( Facade::SimplePose, timestamp ) );
+BOOST_STATIC_ASSERT( sizeof( utshm_position3d ) == sizeof( Facade::SimplePosition3D ) );
+BOOST_STATIC_ASSERT( offsetof( utshm_position3d, timestamp ) == offsetof( Facade::SimplePosition3D, timestamp ) );
+BOOST_STATIC_ASSERT( sizeof( utshm_position2d ) == sizeof( Facade::SimplePosition2D ) );
+BOOST_STATIC_ASSERT( offsetof( utshm_position2d, timestamp ) == offsetof( Facade::SimplePosition2D, timestamp ) );
+BOOST_STATIC_ASSERT( sizeof( utshm_button ) == sizeof( Facade::SimpleButton ) );
+BOOST_STATIC_ASSERT( offsetof( utshm_button, timestamp ) == offsetof( Facade::SimpleButton, timestamp ) );
+
+/** maps an event type to its ring record type and converts records to measurements */
+template< class EventType >
+struct ShmRecord;
+
+template<>
+struct ShmRecord< Measurement::Pose >
+{
+	typedef Facade::SimplePose SimpleType;
+	static const uint32_t s_nType = UTSHM_RECORD_POSE;
+
+	static Measurement::Pose convert( const SimpleType& r, Measurement::Timestamp t )
+	{
+		return Measurement::Pose( t, Math::Pose( Math::Quaternion( r.rx, r.ry, r.rz, r.rw ),
+			Math::Vector< double, 3 >( r.tx, r.ty, r.tz ) ) );
+	}
+};
+
+template<>
+struct ShmRecord< Measurement::Position >
+{
+	typedef Facade::SimplePosition3D SimpleType;
+	static const uint32_t s_nType = UTSHM_RECORD_POSITION3D;
+
+	static Measurement::Position convert( const SimpleType& r, Measurement::Timestamp t )
+	{ return Measurement::Position( t, Math::Vector< double, 3 >( r.x, r.y, r.z ) ); }
+};
+
+template<>
+struct ShmRecord< Measurement::Position2D >
+{
+	typedef Facade::SimplePosition2D SimpleType;
+	static const uint32_t s_nType = UTSHM_RECORD_POSITION2D;
+
+	static Measurement::Position2D convert( const SimpleType& r, Measurement::Timestamp t )
+	{ return Measurement::Position2D( t, Math::Vector< double, 2 >( r.x, r.y ) ); }
+};
+
+template<>
+struct ShmRecord< Measurement::Button >
+{
+	typedef Facade::SimpleButton SimpleType;
+	static const uint32_t s_nType = UTSHM_RECORD_BUTTON;
+
+	static Measurement::Button convert( const SimpleType& r, Measurement::Timestamp t )
+	{ return Measurement::Button( t, Math::Scalar< int >( r.event ) ); }
+};
+
+
+/**
+ * @ingroup dataflow_components
+ * This is a source component which receives events from another process
+ * through a shared-memory ring, see \c utFacade/ShmRing.h for the producer side.
+ *
+ * While the dataflow is running, a poller thread attaches to the POSIX shared-memory
+ * object named by \c shmName and sends every new record through the output port,
+ * in the order the producer wrote them. Records with timestamp 0 are stamped on
+ * arrival. The ring need not exist when the dataflow starts; the poller retries,
+ * and it attaches to a new ring if the producer restarts.
+ *
+ * The poller either sleeps \c pollIntervalUs between checks or, with \c wakeup "futex",
+ * sleeps on a futex which the producer signals after each write (Linux only).
+ * Records pass the same admission policy as in \c ApplicationPushSource.
+ * Not available on Windows.
+ *
+ * @par Input Ports
+ * None.
+ *
+ * @par Output Ports
+ * PushSupplier<EventType> port with name "Output".
+ *
+ * @par Configuration
+ * - \c shmName: name of the shared-memory object, e.g. "/tracker", required
+ * - \c wakeup: "poll" (default) or "futex"
+ * - \c pollIntervalUs: sleep time between checks in "poll" mode, default 1000
+ * - \c admission, \c maxRate, \c coalesceMs, \c maxBacklog: see \c ApplicationPushSource
+ */
+template< class EventType >
+class ApplicationShmPushSource
+	: public Component
+	, public ApplicationPushSourceBase
+{
+public:
+	typedef ShmRecord< EventType > RecordType;
+	typedef typename RecordType::SimpleType SimpleType;
+
+	/**
+	 * UTQL component constructor.
+	 *
+	 * @param nm Unique name of the component.
+	 * @param pConfig \c UTQL subgraph
+	 */
+	ApplicationShmPushSource( const std::string& nm, boost::shared_ptr< Graph::UTQLSubgraph > pConfig )
+		: Ubitrack::Dataflow::Component( nm )
+		, m_outPort( "Output", *this )
+		, m_bFutex( false )
+		, m_nPollIntervalUs( 1000 )
+		, m_pHeader( 0 )
+		, m_pRecords( 0 )
+		, m_nMappedSize( 0 )
+		, m_nCapacity( 0 )
+		, m_nRecordSize( 0 )
+		, m_nDevice( 0 )
+		, m_nInode( 0 )
+		, m_bReportedMismatch( false )
+		, m_bStop( false )
+		, m_logger( log4cpp::Category::getInstance( "Ubitrack.Components.ApplicationShmPushSource" ) )
+	{
+		if ( !pConfig || !pConfig->m_DataflowAttributes.hasAttribute( "shmName" ) )
+			UBITRACK_THROW( "Missing shmName in component " + nm );
+		m_sShmName = pConfig->m_DataflowAttributes.getAttributeString( "shmName" );
+
+		if ( pConfig->m_DataflowAttributes.hasAttribute( "wakeup" ) )
+		{
+			std::string sWakeup( pConfig->m_DataflowAttributes.getAttributeString( "wakeup" ) );
+			if ( sWakeup == "futex" )
+				m_bFutex = true;
+			else if ( sWakeup != "poll" )
+				UBITRACK_THROW( "Invalid wakeup \"" + sWakeup + "\" in component " + nm );
+		}
+
+#ifndef __linux__
+		if ( m_bFutex )
+		{
+			LOG4CPP_WARN( m_logger, "Futex wakeups are not available on this platform, " << nm << " polls instead" );
+			m_bFutex = false;
+		}
+#endif
+
+		if ( pConfig->m_DataflowAttributes.hasAttribute( "pollIntervalUs" ) )
+			pConfig->m_DataflowAttributes.getAttributeData( "pollIntervalUs", m_nPollIntervalUs );
+		if ( m_nPollIntervalUs < 1 )
+			UBITRACK_THROW( "pollIntervalUs must be positive in component " + nm );
+
+		m_admission.setSend( boost::bind( &PushSupplier< EventType >::send, &m_outPort, _1 ) );
+		m_admission.configure( nm, *pConfig );
+	}
+
+	/** stops the poller and unmaps the ring */
+	~ApplicationShmPushSource()
+	{
+		stopPoller();
+		m_admission.stop();
+		detach();
+	}
+
+	/** starts the poller thread */
+	virtual void start()
+	{
+		m_admission.start();
+		if ( !m_pPollerThread )
+		{
+			m_bStop.store( false );
+			m_pPollerThread.reset( new boost::thread( boost::bind( &ApplicationShmPushSource::pollerThread, this ) ) );
+		}
+		Component::start();
+	}
+
+	/** stops the poller thread. Records written while stopped are forwarded after the next start. */
+	virtual void stop()
+	{
+		Component::stop();
+		stopPoller();
+		m_admission.stop();
+	}
+
+	/** returns the admission statistics, records are not parsed */
+	void getStatistics( Facade::SimplePushSourceStats& stats ) const
+	{
+		stats.parseErrors = 0;
+		stats.fastParsed = 0;
+		stats.archiveParsed = 0;
+		stats.admitted = m_admission.admitted();
+		stats.coalesced = m_admission.coalesced();
+		stats.dropped = m_admission.dropped();
+	}
+
+protected:
+	/** interval of attach retries and of checks whether the producer has replaced the ring, in ms */
+	static const int s_nCheckIntervalMs = 100;
+
+	void pollerThread()
+	{
+		Measurement::Timestamp lastCheck( Measurement::now() );
+		while ( !m_bStop.load() )
+		{
+			if ( !m_pHeader && !attach() )
+			{
+				boost::this_thread::sleep( boost::posix_time::milliseconds( s_nCheckIntervalMs ) );
+				continue;
+			}
+
+			if ( forward() )
+				continue;
+
+			// idle: look for a restarted producer from time to time
+			Measurement::Timestamp now( Measurement::now() );
+			if ( now - lastCheck > s_nCheckIntervalMs * 1000000ULL )
+			{
+				lastCheck = now;
+				if ( replaced() )
+				{
+					LOG4CPP_INFO( m_logger, "Shared-memory ring " << m_sShmName << " was replaced, reattaching " << getName() );
+					detach();
+					continue;
+				}
+			}
+
+			wait();
+		}
+	}
+
+	/** sends all available records, returns their number */
+	std::size_t forward()
+	{
+		utshm_ring_header* h = m_pHeader;
+		uint64_t tail = h->tail;
+		uint64_t head = __atomic_load_n( &h->head, __ATOMIC_ACQUIRE );
+		if ( head - tail > m_nCapacity )
+		{
+			LOG4CPP_ERROR( m_logger, "Corrupt shared-memory ring " << m_sShmName << " in " << getName() << ", skipping to the newest record" );
+			__atomic_store_n( &h->tail, head, __ATOMIC_RELEASE );
+			return 0;
+		}
+
+		std::size_t nRecords = static_cast< std::size_t >( head - tail );
+		for ( ; tail != head; tail++ )
+		{
+			SimpleType record;
+			memcpy( &record, m_pRecords + ( tail & ( m_nCapacity - 1 ) ) * m_nRecordSize, sizeof( SimpleType ) );
+
+			// release the slot before sending, the dataflow may take a while
+			__atomic_store_n( &h->tail, tail + 1, __ATOMIC_RELEASE );
+
+			Measurement::Timestamp t( record.timestamp ? record.timestamp : Facade::Clock::now() );
+			m_admission.push( RecordType::convert( record, t ) );
+		}
+		return nRecords;
+	}
+
+	/** waits for new records or until the next check */
+	void wait()
+	{
+#ifdef __linux__
+		if ( m_bFutex )
+		{
+			utshm_ring_header* h = m_pHeader;
+			uint32_t seq = __atomic_load_n( &h->wakeup, __ATOMIC_SEQ_CST );
+			__atomic_store_n( &h->waiting, 1u, __ATOMIC_SEQ_CST );
+			if ( __atomic_load_n( &h->head, __ATOMIC_SEQ_CST ) == h->tail && !m_bStop.load() )
+			{
+				struct timespec timeout = { 0, s_nCheckIntervalMs * 1000000L };
+				syscall( SYS_futex, &h->wakeup, FUTEX_WAIT, seq, &timeout, NULL, 0 );
+			}
+			__atomic_store_n( &h->waiting, 0u, __ATOMIC_SEQ_CST );
+			return;
+		}
+#endif
+		boost::this_thread::sleep( boost::posix_time::microseconds( m_nPollIntervalUs ) );
+	}
+
+	/** maps the ring if it exists and matches the event type */
+	bool attach()
+	{
+		int fd = shm_open( m_sShmName.c_str(), O_RDWR, 0 );
+		if ( fd < 0 )
+			return false;
+
+		struct stat st;
+		if ( fstat( fd, &st ) != 0 || st.st_size < static_cast< off_t >( sizeof( utshm_ring_header ) ) )
+		{
+			// still being created
+			close( fd );
+			return false;
+		}
+
+		std::size_t nSize = static_cast< std::size_t >( st.st_size );
+		void* p = mmap( NULL, nSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		close( fd );
+		if ( p == MAP_FAILED )
+			return false;
+
+		utshm_ring_header* h = static_cast< utshm_ring_header* >( p );
+		if ( __atomic_load_n( &h->magic, __ATOMIC_ACQUIRE ) != UTSHM_RING_MAGIC )
+		{
+			munmap( p, nSize );
+			return false;
+		}
+
+		// the producer can write the header at any time, so validate and keep private copies
+		const uint32_t nRecordSize = h->record_size;
+		const uint64_t nCapacity = h->capacity;
+		if ( h->version != UTSHM_RING_VERSION || h->record_type != RecordType::s_nType || nRecordSize != sizeof( SimpleType )
+			|| nCapacity == 0 || ( nCapacity & ( nCapacity - 1 ) ) != 0
+			|| nCapacity > ( nSize - sizeof( utshm_ring_header ) ) / nRecordSize )
+		{
+			if ( !m_bReportedMismatch )
+				LOG4CPP_ERROR( m_logger, "Shared-memory ring " << m_sShmName << " does not match " << getName()
+					<< " (version " << h->version << ", record type " << h->record_type << ", record size " << nRecordSize
+					<< ", capacity " << nCapacity << ")" );
+			m_bReportedMismatch = true;
+			munmap( p, nSize );
+			return false;
+		}
+
+		m_pHeader = h;
+		m_pRecords = static_cast< unsigned char* >( p ) + sizeof( utshm_ring_header );
+		m_nMappedSize = nSize;
+		m_nCapacity = nCapacity;
+		m_nRecordSize = nRecordSize;
+		m_nDevice = st.st_dev;
+		m_nInode = st.st_ino;
+		m_bReportedMismatch = false;
+		LOG4CPP_INFO( m_logger, getName() << " attached to shared-memory ring " << m_sShmName << " with " << nCapacity << " records" );
+		return true;
+	}
+
+	/** true if the name no longer refers to the mapped ring */
+	bool replaced()
+	{
+		int fd = shm_open( m_sShmName.c_str(), O_RDONLY, 0 );
+		if ( fd < 0 )
+			return true;
+
+		struct stat st;
+		bool bReplaced = fstat( fd, &st ) != 0 || st.st_dev != m_nDevice || st.st_ino != m_nInode;
+		close( fd );
+		return bReplaced;
+	}
+
+	/** unmaps the ring */
+	void detach()
+	{
+		if ( !m_pHeader )
+			return;
+
+		unsigned long long nDropped = __atomic_load_n( &m_pHeader->dropped, __ATOMIC_RELAXED );
+		if ( nDropped )
+			LOG4CPP_WARN( m_logger, "Producer of " << m_sShmName << " dropped " << nDropped << " records because the ring was full" );
+
+		munmap( m_pHeader, m_nMappedSize );
+		m_pHeader = 0;
+		m_pRecords = 0;
+	}
+
+	/** stops and joins the poller thread, which notices the stop within s_nCheckIntervalMs */
+	void stopPoller()
+	{
+		if ( !m_pPollerThread )
+			return;
+
+		m_bStop.store( true );
+		m_pPollerThread->join();
+		m_pPollerThread.reset();
+	}
+
+	/** Output port of the component. */
+	PushSupplier< EventType > m_outPort;
+
+	/** admission policy in front of the port */
+	PushAdmission< EventType > m_admission;
+
+	/** configuration */
+	std::string m_sShmName;
+	bool m_bFutex;
+	int m_nPollIntervalUs;
+
+	/** the mapped ring, only used by the poller thread */
+	utshm_ring_header* m_pHeader;
+	unsigned char* m_pRecords;
+	std::size_t m_nMappedSize;
+
+	/** capacity and record size validated in attach(), the header fields are never read again */
+	uint64_t m_nCapacity;
+	std::size_t m_nRecordSize;
+	dev_t m_nDevice;
+	ino_t m_nInode;
+	bool m_bReportedMismatch;
+
+	boost::atomic< bool > m_bStop;
+	boost::scoped_ptr< boost::thread > m_pPollerThread;
+
+	/** reference to logger */
+	log4cpp::Category& m_logger;
+};
+
+template< class EventType >
+const int ApplicationShmPushSource< EventType >::s_nCheckIntervalMs;
+
+typedef ApplicationShmPushSource< Measurement::Pose > ApplicationShmPushSourcePose;
+typedef ApplicationShmPushSource< Measurement::Position > ApplicationShmPushSourcePosition;
+typedef ApplicationShmPushSource< Measurement::Position2D > ApplicationShmPushSourcePosition2D;
+typedef ApplicationShmPushSource< Measurement::Button > ApplicationShmPushSourceButton;
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_APPLICATIONSHMPUSHSOURCE_H_INCLUDED__
@@ -0,0 +1,162 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Lock-free histogram for latency measurements of the application endpoints.
+ */
+#ifndef __UBITRACK_COMPONENTS_LATENCYHISTOGRAM_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_LATENCYHISTOGRAM_H_INCLUDED__
+
+#include <boost/atomic.hpp>
+
+namespace Ubitrack { namespace Components {
+
+/**
+ * Log-linear histogram of durations in nanoseconds.
+ *
+ * Each power of two is divided into \c s_nSubBuckets linear buckets, so the relative
+ * error of a percentile is below 1/s_nSubBuckets over the whole 64 bit range.
+ * Adding a value is wait-free and may be done from several threads. Reading and
+ * resetting do not take a consistent snapshot, which is fine for monitoring.
+ */
+class LatencyHistogram
+{
+public:
+	LatencyHistogram()
+	{
+		reset();
+	}
+
+	/** adds a value */
+	void add( unsigned long long value )
+	{
+		m_buckets[ bucketIndex( value ) ].fetch_add( 1, boost::memory_order_relaxed );
+		m_nCount.fetch_add( 1, boost::memory_order_relaxed );
+
+		unsigned long long max = m_max.load( boost::memory_order_relaxed );
+		while ( value > max && !m_max.compare_exchange_weak( max, value, boost::memory_order_relaxed ) )
+			;
+	}
+
+	/** clears all buckets */
+	void reset()
+	{
+		for ( unsigned int i = 0; i < s_nBuckets; i++ )
+			m_buckets[ i ].store( 0, boost::memory_order_relaxed );
+		m_nCount.store( 0, boost::memory_order_relaxed );
+		m_max.store( 0, boost::memory_order_relaxed );
+	}
+
+	/** number of values added since the last reset */
+	unsigned long long count() const
+	{
+		return m_nCount.load( boost::memory_order_relaxed );
+	}
+
+	/** largest value added since the last reset */
+	unsigned long long max() const
+	{
+		return m_max.load( boost::memory_order_relaxed );
+	}
+
+	/**
+	 * Computes an approximate percentile.
+	 * @param p the percentile as fraction between 0 and 1
+	 * @return the midpoint of the bucket containing the percentile, never more than max(), 0 if empty
+	 */
+	unsigned long long percentile( double p ) const
+	{
+		unsigned long long nTotal = 0;
+		for ( unsigned int i = 0; i < s_nBuckets; i++ )
+			nTotal += m_buckets[ i ].load( boost::memory_order_relaxed );
+		if ( nTotal == 0 )
+			return 0;
+
+		unsigned long long nRank = static_cast< unsigned long long >( p * nTotal + 0.5 );
+		if ( nRank < 1 )
+			nRank = 1;
+
+		unsigned long long nSeen = 0;
+		for ( unsigned int i = 0; i < s_nBuckets; i++ )
+		{
+			nSeen += m_buckets[ i ].load( boost::memory_order_relaxed );
+			if ( nSeen >= nRank )
+			{
+				unsigned long long value = bucketMidpoint( i );
+				unsigned long long nMax = max();
+				return value < nMax ? value : nMax;
+			}
+		}
+		return max();
+	}
+
+protected:
+	/** number of linear buckets per power of two, must be a power of two */
+	static const unsigned int s_nSubBucketBits = 3;
+	static const unsigned int s_nSubBuckets = 1 << s_nSubBucketBits;
+	static const unsigned int s_nBuckets = ( 64 - s_nSubBucketBits + 1 ) * s_nSubBuckets;
+
+	/** position of the highest set bit */
+	static unsigned int log2Floor( unsigned long long v )
+	{
+		unsigned int r = 0;
+		if ( v >> 32 ) { v >>= 32; r += 32; }
+		if ( v >> 16 ) { v >>= 16; r += 16; }
+		if ( v >> 8 ) { v >>= 8; r += 8; }
+		if ( v >> 4 ) { v >>= 4; r += 4; }
+		if ( v >> 2 ) { v >>= 2; r += 2; }
+		if ( v >> 1 ) { r += 1; }
+		return r;
+	}
+
+	static unsigned int bucketIndex( unsigned long long value )
+	{
+		if ( value < s_nSubBuckets )
+			return static_cast< unsigned int >( value );
+
+		unsigned int nShift = log2Floor( value ) - s_nSubBucketBits;
+		unsigned int nSub = static_cast< unsigned int >( value >> nShift ) & ( s_nSubBuckets - 1 );
+		return ( nShift + 1 ) * s_nSubBuckets + nSub;
+	}
+
+	static unsigned long long bucketMidpoint( unsigned int index )
+	{
+		if ( index < s_nSubBuckets )
+			return index;
+
+		unsigned int nShift = index / s_nSubBuckets - 1;
+		unsigned long long low = static_cast< unsigned long long >( s_nSubBuckets + index % s_nSubBuckets ) << nShift;
+		return low + ( ( 1ULL << nShift ) >> 1 );
+	}
+
+	boost::atomic< unsigned long long > m_buckets[ s_nBuckets ];
+	boost::atomic< unsigned long long > m_nCount;
+	boost::atomic< unsigned long long > m_max;
+};
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_LATENCYHISTOGRAM_H_INCLUDED__
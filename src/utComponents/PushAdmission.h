@@ -0,0 +1,306 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Admission policies that protect the dataflow from bursts of application events.
+ */
+#ifndef __UBITRACK_COMPONENTS_PUSHADMISSION_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_PUSHADMISSION_H_INCLUDED__
+
+#include <deque>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <utMeasurement/Measurement.h>
+#include <utFacade/Clock.h>
+#include <utUtil/Exception.h>
+#include <utGraph/UTQLSubgraph.h>
+
+namespace Ubitrack { namespace Components {
+
+/**
+ * Decides which events an application push source passes on to the dataflow.
+ *
+ * - \c AdmitAll passes every event on.
+ * - \c AdmitMaxRate drops events that arrive less than the minimum interval after the last admitted event.
+ * - \c AdmitCoalesce sends an event immediately if the last one was admitted at least a window ago.
+ *   Otherwise the event is held and replaced by newer events ("coalesced"), and the latest one is
+ *   sent when the window has passed.
+ * - \c AdmitDropOldest keeps a bounded backlog that is sent at most at the rate given by the minimum
+ *   interval. When the backlog is full, the oldest event is dropped.
+ *
+ * Times are arrival times, not event timestamps. Held events are sent by a worker thread, which
+ * runs between \c start and \c stop; events still held on \c stop are dropped.
+ * \c push may be called from several threads.
+ */
+template< class EventType >
+class PushAdmission
+{
+public:
+	enum Policy { AdmitAll, AdmitMaxRate, AdmitCoalesce, AdmitDropOldest };
+
+	typedef boost::function< void( const EventType& ) > SendType;
+
+	PushAdmission()
+		: m_policy( AdmitAll )
+		, m_nInterval( 0 )
+		, m_nMaxBacklog( 16 )
+		, m_nAdmitted( 0 )
+		, m_nCoalesced( 0 )
+		, m_nDropped( 0 )
+		, m_lastAdmitted( 0 )
+		, m_bStop( false )
+	{}
+
+	~PushAdmission()
+	{
+		stop();
+	}
+
+	/**
+	 * Sets the policy, must be called before \c start.
+	 * @param policy the admission policy
+	 * @param nIntervalNs minimum interval for \c AdmitMaxRate and \c AdmitDropOldest, window for \c AdmitCoalesce
+	 * @param nMaxBacklog backlog size for \c AdmitDropOldest
+	 */
+	void configure( Policy policy, Measurement::Timestamp nIntervalNs, std::size_t nMaxBacklog )
+	{
+		m_policy = policy;
+		m_nInterval = nIntervalNs;
+		m_nMaxBacklog = nMaxBacklog;
+	}
+
+	/**
+	 * Reads the policy from the dataflow attributes \c admission, \c maxRate, \c coalesceMs
+	 * and \c maxBacklog. Throws if they are invalid.
+	 */
+	void configure( const std::string& nm, Graph::UTQLSubgraph& config )
+	{
+		if ( !config.m_DataflowAttributes.hasAttribute( "admission" ) )
+			return;
+
+		std::string sPolicy( config.m_DataflowAttributes.getAttributeString( "admission" ) );
+		Policy policy;
+		if ( sPolicy == "all" )
+			return;
+		else if ( sPolicy == "maxRate" )
+			policy = AdmitMaxRate;
+		else if ( sPolicy == "coalesce" )
+			policy = AdmitCoalesce;
+		else if ( sPolicy == "dropOldest" )
+			policy = AdmitDropOldest;
+		else
+			UBITRACK_THROW( "Invalid admission \"" + sPolicy + "\" in component " + nm );
+
+		Measurement::Timestamp nInterval = 0;
+		if ( policy == AdmitCoalesce )
+		{
+			int nWindowMs = 0;
+			if ( config.m_DataflowAttributes.hasAttribute( "coalesceMs" ) )
+				config.m_DataflowAttributes.getAttributeData( "coalesceMs", nWindowMs );
+			if ( nWindowMs <= 0 )
+				UBITRACK_THROW( "coalesceMs must be positive in component " + nm );
+			nInterval = static_cast< Measurement::Timestamp >( nWindowMs ) * 1000000ULL;
+		}
+		else
+		{
+			double dMaxRate = 0.0;
+			if ( config.m_DataflowAttributes.hasAttribute( "maxRate" ) )
+				config.m_DataflowAttributes.getAttributeData( "maxRate", dMaxRate );
+			if ( !( dMaxRate > 0.0 ) )
+				UBITRACK_THROW( "maxRate must be positive in component " + nm );
+			nInterval = static_cast< Measurement::Timestamp >( 1e9 / dMaxRate );
+		}
+
+		int nMaxBacklog = 16;
+		if ( config.m_DataflowAttributes.hasAttribute( "maxBacklog" ) )
+			config.m_DataflowAttributes.getAttributeData( "maxBacklog", nMaxBacklog );
+		if ( nMaxBacklog < 1 )
+			UBITRACK_THROW( "maxBacklog must be positive in component " + nm );
+
+		configure( policy, nInterval, static_cast< std::size_t >( nMaxBacklog ) );
+	}
+
+	/** sets the function that passes admitted events on */
+	void setSend( const SendType& send )
+	{ m_send = send; }
+
+	/** offers an event */
+	void push( const EventType& e )
+	{
+		switch ( m_policy )
+		{
+			case AdmitAll:
+				admit( e );
+				break;
+
+			case AdmitMaxRate:
+			{
+				Measurement::Timestamp now( Facade::Clock::now() );
+				Measurement::Timestamp last( m_lastAdmitted.load( boost::memory_order_relaxed ) );
+				if ( ( last && now - last < m_nInterval ) || !m_lastAdmitted.compare_exchange_strong( last, now, boost::memory_order_relaxed ) )
+					m_nDropped.fetch_add( 1, boost::memory_order_relaxed );
+				else
+					admit( e );
+				break;
+			}
+
+			case AdmitCoalesce:
+			case AdmitDropOldest:
+			{
+				boost::mutex::scoped_lock lock( m_mutex );
+				Measurement::Timestamp now( Facade::Clock::now() );
+				if ( m_backlog.empty() && due( now ) )
+				{
+					// nothing held and not too early: no need to involve the worker
+					m_lastAdmitted.store( now, boost::memory_order_relaxed );
+					admit( e );
+					break;
+				}
+
+				if ( m_policy == AdmitCoalesce && !m_backlog.empty() )
+				{
+					m_backlog.front() = e;
+					m_nCoalesced.fetch_add( 1, boost::memory_order_relaxed );
+					break;
+				}
+
+				if ( m_backlog.size() >= m_nMaxBacklog )
+				{
+					m_backlog.pop_front();
+					m_nDropped.fetch_add( 1, boost::memory_order_relaxed );
+				}
+				m_backlog.push_back( e );
+				m_condition.notify_one();
+				break;
+			}
+		}
+	}
+
+	/** starts the worker thread, if the policy needs one */
+	void start()
+	{
+		if ( ( m_policy == AdmitCoalesce || m_policy == AdmitDropOldest ) && !m_pThread )
+		{
+			m_bStop.store( false );
+			m_pThread.reset( new boost::thread( boost::bind( &PushAdmission::workerThread, this ) ) );
+		}
+	}
+
+	/** stops the worker thread and drops held events */
+	void stop()
+	{
+		if ( !m_pThread )
+			return;
+
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			m_bStop.store( true );
+			m_condition.notify_one();
+		}
+		m_pThread->join();
+		m_pThread.reset();
+
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_nDropped.fetch_add( m_backlog.size(), boost::memory_order_relaxed );
+		m_backlog.clear();
+	}
+
+	unsigned long long admitted() const
+	{ return m_nAdmitted.load( boost::memory_order_relaxed ); }
+
+	unsigned long long coalesced() const
+	{ return m_nCoalesced.load( boost::memory_order_relaxed ); }
+
+	unsigned long long dropped() const
+	{ return m_nDropped.load( boost::memory_order_relaxed ); }
+
+protected:
+	/** true if an event may be sent at time \p now */
+	bool due( Measurement::Timestamp now ) const
+	{
+		Measurement::Timestamp last( m_lastAdmitted.load( boost::memory_order_relaxed ) );
+		return !last || now - last >= m_nInterval;
+	}
+
+	void admit( const EventType& e )
+	{
+		m_send( e );
+		m_nAdmitted.fetch_add( 1, boost::memory_order_relaxed );
+	}
+
+	/** sends held events when they are due. Sends under the lock to keep the event order. */
+	void workerThread()
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		while ( !m_bStop.load() )
+		{
+			if ( m_backlog.empty() )
+			{
+				m_condition.wait( lock );
+				continue;
+			}
+
+			Measurement::Timestamp now( Facade::Clock::now() );
+			if ( !due( now ) )
+			{
+				Measurement::Timestamp nWait( m_lastAdmitted.load( boost::memory_order_relaxed ) + m_nInterval - now );
+				m_condition.timed_wait( lock, boost::posix_time::microseconds( static_cast< long >( nWait / 1000 + 1 ) ) );
+				continue;
+			}
+
+			m_lastAdmitted.store( now, boost::memory_order_relaxed );
+			admit( m_backlog.front() );
+			m_backlog.pop_front();
+		}
+	}
+
+	Policy m_policy;
+	Measurement::Timestamp m_nInterval;
+	std::size_t m_nMaxBacklog;
+	SendType m_send;
+
+	boost::atomic< unsigned long long > m_nAdmitted;
+	boost::atomic< unsigned long long > m_nCoalesced;
+	boost::atomic< unsigned long long > m_nDropped;
+
+	/** arrival time of the last admitted event, 0 if none */
+	boost::atomic< Measurement::Timestamp > m_lastAdmitted;
+
+	/** held events, at most one for \c AdmitCoalesce */
+	std::deque< EventType > m_backlog;
+	boost::mutex m_mutex;
+	boost::condition_variable m_condition;
+	boost::atomic< bool > m_bStop;
+	boost::scoped_ptr< boost::thread > m_pThread;
+};
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_PUSHADMISSION_H_INCLUDED__
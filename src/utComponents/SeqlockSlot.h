@@ -0,0 +1,142 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Single-value slot with sequence lock, used to publish the latest value of a push sink.
+ */
+#ifndef __UBITRACK_COMPONENTS_SEQLOCKSLOT_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_SEQLOCKSLOT_H_INCLUDED__
+
+#include <string.h>
+#include <typeinfo>
+#include <boost/atomic.hpp>
+
+namespace Ubitrack { namespace Components {
+
+/** type independent base of SeqlockSlot */
+class SeqlockSlotBase
+{
+public:
+	/** type of the stored value */
+	virtual const std::type_info& type() const = 0;
+
+	/** virtual destructor */
+	virtual ~SeqlockSlotBase()
+	{}
+};
+
+/**
+ * Holds the latest value of a plain data type \p T.
+ *
+ * Writers increment a sequence number before and after storing the value, readers
+ * retry if the sequence number was odd or has changed during the read. Readers never
+ * block the writer and never take a lock, so a read costs a few loads. Several
+ * writers are serialized by a compare-and-swap on the sequence number.
+ *
+ * The value is stored as an array of atomic words, so \p T must be copyable with memcpy.
+ * The slot is padded so that it does not share a cache line with other data.
+ */
+template< class T >
+class SeqlockSlot
+	: public SeqlockSlotBase
+{
+public:
+	SeqlockSlot()
+		: m_nSequence( 0 )
+	{
+		for ( std::size_t i = 0; i < s_nWords; i++ )
+			m_words[ i ].store( 0, boost::memory_order_relaxed );
+	}
+
+	/** @copydoc SeqlockSlotBase::type */
+	const std::type_info& type() const
+	{ return typeid( T ); }
+
+	/** stores a new value */
+	void write( const T& value )
+	{
+		unsigned long long buffer[ s_nWords ];
+		buffer[ s_nWords - 1 ] = 0;
+		memcpy( buffer, &value, sizeof( T ) );
+
+		unsigned int nSequence = m_nSequence.load( boost::memory_order_relaxed );
+		while ( ( nSequence & 1 ) || !m_nSequence.compare_exchange_weak( nSequence, nSequence + 1, boost::memory_order_acquire ) )
+			nSequence = m_nSequence.load( boost::memory_order_relaxed );
+		boost::atomic_thread_fence( boost::memory_order_release );
+
+		for ( std::size_t i = 0; i < s_nWords; i++ )
+			m_words[ i ].store( buffer[ i ], boost::memory_order_relaxed );
+
+		// 0 means that nothing was written, skip it when the sequence wraps around
+		unsigned int nNext = nSequence + 2;
+		if ( nNext == 0 )
+			nNext = 2;
+		m_nSequence.store( nNext, boost::memory_order_release );
+	}
+
+	/**
+	 * Reads the latest value.
+	 * @return false if no value has been written yet
+	 */
+	bool read( T& value ) const
+	{
+		unsigned long long buffer[ s_nWords ];
+		while ( true )
+		{
+			unsigned int nBefore = m_nSequence.load( boost::memory_order_acquire );
+			if ( nBefore == 0 )
+				return false;
+			if ( nBefore & 1 )
+				continue;
+
+			for ( std::size_t i = 0; i < s_nWords; i++ )
+				buffer[ i ] = m_words[ i ].load( boost::memory_order_relaxed );
+
+			boost::atomic_thread_fence( boost::memory_order_acquire );
+			if ( m_nSequence.load( boost::memory_order_relaxed ) == nBefore )
+				break;
+		}
+
+		memcpy( &value, buffer, sizeof( T ) );
+		return true;
+	}
+
+protected:
+	static const std::size_t s_nWords = ( sizeof( T ) + sizeof( unsigned long long ) - 1 ) / sizeof( unsigned long long );
+
+	/** keeps other data out of the cache line of the sequence number */
+	char m_padBefore[ 64 ];
+
+	/** even if the value is stable, odd while it is being written, 0 if nothing was written yet */
+	boost::atomic< unsigned int > m_nSequence;
+
+	boost::atomic< unsigned long long > m_words[ s_nWords ];
+
+	char m_padAfter[ 64 ];
+};
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_SEQLOCKSLOT_H_INCLUDED__
@@ -0,0 +1,163 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+
+/**
+ * @ingroup dataflow_components
+ * @file
+ * Small cache of measurements keyed by timestamp, used by the application pull sinks.
+ */
+#ifndef __UBITRACK_COMPONENTS_TIMESTAMPCACHE_H_INCLUDED__
+#define __UBITRACK_COMPONENTS_TIMESTAMPCACHE_H_INCLUDED__
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <utMeasurement/Measurement.h>
+
+namespace Ubitrack { namespace Components {
+
+/**
+ * Fixed-size cache of (timestamp, value) pairs.
+ *
+ * Meant for a handful of entries, e.g. the timestamps of the frames currently being
+ * rendered, so lookups scan all entries. When the cache is full, the oldest entry is
+ * replaced. A capacity of 0 disables the cache; \c lookup then returns false without
+ * taking the lock or counting a miss.
+ *
+ * All functions may be called from several threads.
+ */
+template< class T >
+class TimestampCache
+{
+public:
+	TimestampCache( std::size_t nCapacity = 0 )
+		: m_nCapacity( 0 )
+		, m_nNext( 0 )
+		, m_nHits( 0 )
+		, m_nMisses( 0 )
+	{
+		setCapacity( nCapacity );
+	}
+
+	/** changes the number of entries, clearing the cache */
+	void setCapacity( std::size_t nCapacity )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_entries.assign( nCapacity, Entry() );
+		m_nNext = 0;
+		m_nCapacity.store( nCapacity, boost::memory_order_relaxed );
+	}
+
+	std::size_t capacity() const
+	{ return m_nCapacity.load( boost::memory_order_relaxed ); }
+
+	/**
+	 * Looks up the value for a timestamp.
+	 * @return true if found, the value is then copied to \p value
+	 */
+	bool lookup( Measurement::Timestamp t, T& value )
+	{
+		if ( capacity() == 0 )
+			return false;
+
+		boost::mutex::scoped_lock lock( m_mutex );
+		for ( std::size_t i = 0; i < m_entries.size(); i++ )
+			if ( m_entries[ i ].bValid && m_entries[ i ].timestamp == t )
+			{
+				value = m_entries[ i ].value;
+				m_nHits.fetch_add( 1, boost::memory_order_relaxed );
+				return true;
+			}
+
+		m_nMisses.fetch_add( 1, boost::memory_order_relaxed );
+		return false;
+	}
+
+	/** stores a value, replacing the oldest entry if the cache is full */
+	void insert( Measurement::Timestamp t, const T& value )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		if ( m_entries.empty() )
+			return;
+
+		// another thread may have inserted the same timestamp in the meantime
+		for ( std::size_t i = 0; i < m_entries.size(); i++ )
+			if ( m_entries[ i ].bValid && m_entries[ i ].timestamp == t )
+				return;
+
+		Entry& entry = m_entries[ m_nNext ];
+		entry.timestamp = t;
+		entry.value = value;
+		entry.bValid = true;
+		m_nNext = ( m_nNext + 1 ) % m_entries.size();
+	}
+
+	/** removes all entries, keeping the capacity */
+	void clear()
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		for ( std::size_t i = 0; i < m_entries.size(); i++ )
+			m_entries[ i ] = Entry();
+		m_nNext = 0;
+	}
+
+	/** number of successful lookups */
+	unsigned long long hits() const
+	{ return m_nHits.load( boost::memory_order_relaxed ); }
+
+	/** number of failed lookups while the cache was enabled */
+	unsigned long long misses() const
+	{ return m_nMisses.load( boost::memory_order_relaxed ); }
+
+	/** sets the hit and miss counters to 0 */
+	void resetCounters()
+	{
+		m_nHits.store( 0, boost::memory_order_relaxed );
+		m_nMisses.store( 0, boost::memory_order_relaxed );
+	}
+
+protected:
+	struct Entry
+	{
+		Entry()
+			: timestamp( 0 )
+			, bValid( false )
+		{}
+
+		Measurement::Timestamp timestamp;
+		T value;
+		bool bValid;
+	};
+
+	std::vector< Entry > m_entries;
+	boost::atomic< std::size_t > m_nCapacity;
+	std::size_t m_nNext;
+	boost::mutex m_mutex;
+	boost::atomic< unsigned long long > m_nHits;
+	boost::atomic< unsigned long long > m_nMisses;
+};
+
+} } // namespace Ubitrack::Components
+
+#endif //__UBITRACK_COMPONENTS_TIMESTAMPCACHE_H_INCLUDED__
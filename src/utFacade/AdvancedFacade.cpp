@@ -30,16 +30,19 @@
  */
 
 #include <fstream>
+#include <algorithm>
 #include <sstream>
 #include <log4cpp/Category.hh>
 
 #include <utUtil/Exception.h>
 #include <utDataflow/EventQueue.h>
 #include <utGraph/UTQLReader.h>
+#include <utGraph/UTQLDocument.h>
 #include <utGraph/DataflowGeneration.h>
 
 #include "AdvancedFacade.h"
 #include "DataflowObserver.h"
+#include "CallbackExecutor.h"
 
 #include <utDataflow/ComponentFactory.h>
 #include <boost/asio.hpp>
@@ -61,7 +64,8 @@ static const char* g_defaultPort = "3000";
 namespace Ubitrack { namespace Facade {
 
 AdvancedFacade::AdvancedFacade( const std::string& sComponentPath )
-	: m_bStarted( false )
+	: m_nCallbackThreads( std::max( 1u, std::min( 4u, boost::thread::hardware_concurrency() ) ) )
+	, m_bStarted( false )
 	, m_pIoService( new boost::asio::io_service )
 {
 	if ( !sComponentPath.empty() )
@@ -173,12 +177,16 @@ void AdvancedFacade::loadDataflow( std::istream& stream, bool bReplace )
 
 		// finally, copy to global pointer (here for exception safety)
 		m_pDataflowNetwork = pDfn;
+		attachCallbackExecutor( *doc );
 		
 		if ( m_bStarted )
 			startDataflow();
 	}
 	else
+	{
 		m_pDataflowNetwork->processUTQLResponse( doc );
+		attachCallbackExecutor( *doc );
+	}
 
 	// notify observers of additions
 	for ( ObserverList::iterator itObserver = m_observers.begin(); itObserver != m_observers.end(); itObserver++ )
@@ -237,6 +245,36 @@ void AdvancedFacade::stopDataflow()
 }
 
 
+void AdvancedFacade::setCallbackThreads( std::size_t nThreads )
+{
+	if ( nThreads < 1 )
+		UBITRACK_THROW( "The callback executor needs at least one thread" );
+
+	m_nCallbackThreads = nThreads;
+	if ( m_pCallbackExecutor )
+		m_pCallbackExecutor->resize( nThreads );
+}
+
+
+void AdvancedFacade::attachCallbackExecutor( Graph::UTQLDocument& doc )
+{
+	for ( Graph::UTQLDocument::SubgraphList::iterator it = doc.m_Subgraphs.begin(); it != doc.m_Subgraphs.end(); it++ )
+	{
+		if ( (*it)->empty() || !(*it)->m_DataflowAttributes.hasAttribute( "deliveryMode" ) || 
+			(*it)->m_DataflowAttributes.getAttributeString( "deliveryMode" ) != "executor" )
+			continue;
+
+		if ( !m_pCallbackExecutor )
+		{
+			LOG4CPP_DEBUG( logger, "Starting callback executor with " << m_nCallbackThreads << " threads" );
+			m_pCallbackExecutor.reset( new CallbackExecutor( m_nCallbackThreads ) );
+		}
+
+		componentByName< Components::ApplicationPushSinkBase >( (*it)->m_ID )->setExecutor( m_pCallbackExecutor.get() );
+	}
+}
+
+
 void AdvancedFacade::connectToServer( const std::string& sAddress )
 {
 	LOG4CPP_DEBUG( logger, "AdvancedFacade::connectToServer " << sAddress );
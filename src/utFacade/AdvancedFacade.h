@@ -47,6 +47,9 @@ namespace Ubitrack {
 	namespace Dataflow {
 		class ComponentFactory;
 	}
+	namespace Graph {
+		class UTQLDocument;
+	}
 	namespace ClientServer {
 		class TcpConnection;
 	}
@@ -64,6 +67,7 @@ namespace Ubitrack { namespace Facade {
 
 // forward decls
 class DataflowObserver;
+class CallbackExecutor;
 
 
 /**
@@ -114,6 +118,15 @@ public:
 	/** stops components and the event queue */
 	void stopDataflow();
 
+	/**
+	 * Sets the number of threads that run the callbacks of \c ApplicationPushSink components
+	 * in \c executor delivery mode. Waits for running callbacks to finish. The threads are
+	 * created when the first such sink is loaded; the default is the number of cores, at most 4.
+	 *
+	 * @param nThreads number of threads, at least 1
+	 */
+	void setCallbackThreads( std::size_t nThreads );
+
 	
 	/** 
 	 * connect to a ubitrack server.
@@ -147,7 +160,11 @@ public:
 	 */
 	template< class ComponentClass >
 	boost::shared_ptr< ComponentClass > componentByName( const std::string& sComponentName )
-	{ return m_pDataflowNetwork->componentByName< ComponentClass >( sComponentName ); }
+	{
+		if ( !m_pDataflowNetwork )
+			UBITRACK_THROW( "No dataflow loaded, cannot find component " + sComponentName );
+		return m_pDataflowNetwork->componentByName< ComponentClass >( sComponentName );
+	}
 	
 	/**
 	 * Sets a callback on an \c ApplicationPushSink.
@@ -161,6 +178,76 @@ public:
 	void setCallback( const std::string& sComponentName, boost::function< void( const EventType& ) > callback )
 	{ componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->setCallback( callback ); }
 
+	/**
+	 * Sets a batch callback on an \c ApplicationPushSink.
+	 * Throws an exception if not found.
+	 *
+	 * @param EventType type of events to send
+	 * @param sComponentName name of the \c ApplicationPushSink component on which to set the callback
+	 * @param callback \c boost::function to call with the collected events
+	 * @param nMaxEvents maximum number of events per call
+	 * @param nMaxDelayUs maximum time in microseconds an event waits for the batch to fill up,
+	 *        not supported in synchronous delivery and on the callback executor
+	 */
+	template< class EventType >
+	void setBatchCallback( const std::string& sComponentName, boost::function< void( const EventType*, std::size_t ) > callback,
+		std::size_t nMaxEvents, unsigned long long nMaxDelayUs )
+	{ componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->setBatchCallback( callback, nMaxEvents, nMaxDelayUs ); }
+
+	/**
+	 * Sets a receiver for the simple datatype on an \c ApplicationPushSink.
+	 * Throws an exception if not found.
+	 *
+	 * @param EventType type of events to send
+	 * @param sComponentName name of the \c ApplicationPushSink component on which to set the receiver
+	 * @param pReceiver receiver to call with the converted events
+	 */
+	template< class EventType >
+	void setReceiver( const std::string& sComponentName, typename SimpleConverter< EventType >::ReceiverType* pReceiver )
+	{ componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->setReceiver( pReceiver ); }
+
+	/**
+	 * Adds a callback to an \c ApplicationPushSink in addition to the existing ones.
+	 * Throws an exception if not found.
+	 *
+	 * @param EventType type of events to send
+	 * @param sComponentName name of the \c ApplicationPushSink component
+	 * @param callback \c boost::function to call when an event is received
+	 * @return handle for \c ApplicationPushSinkBase::removeSubscriber
+	 */
+	template< class EventType >
+	unsigned int addCallback( const std::string& sComponentName, boost::function< void( const EventType& ) > callback )
+	{ return componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->addCallback( callback ); }
+
+	/**
+	 * Adds a receiver for the simple datatype to an \c ApplicationPushSink in addition to the existing ones.
+	 * Throws an exception if not found.
+	 *
+	 * @param EventType type of events to send
+	 * @param sComponentName name of the \c ApplicationPushSink component
+	 * @param pReceiver receiver to call with the converted events
+	 * @return handle for \c ApplicationPushSinkBase::removeSubscriber
+	 */
+	template< class EventType >
+	unsigned int addReceiver( const std::string& sComponentName, typename SimpleConverter< EventType >::ReceiverType* pReceiver )
+	{ return componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->addReceiver( pReceiver ); }
+
+	/**
+	 * Sets a batch receiver for the simple datatype on an \c ApplicationPushSink.
+	 * Throws an exception if not found.
+	 *
+	 * @param EventType type of events to send
+	 * @param sComponentName name of the \c ApplicationPushSink component on which to set the receiver
+	 * @param pReceiver receiver to call with the converted events
+	 * @param nMaxEvents maximum number of events per call
+	 * @param nMaxDelayUs maximum time in microseconds an event waits for the batch to fill up,
+	 *        not supported in synchronous delivery and on the callback executor
+	 */
+	template< class EventType >
+	void setBatchReceiver( const std::string& sComponentName, typename SimpleConverter< EventType >::BatchReceiverType* pReceiver,
+		std::size_t nMaxEvents, unsigned long long nMaxDelayUs )
+	{ componentByName< Components::ApplicationPushSink< EventType > >( sComponentName )->setBatchReceiver( pReceiver, nMaxEvents, nMaxDelayUs ); }
+
 	
 	/**
 	 * Adds a data flow observer to the observer list
@@ -182,6 +269,12 @@ public:
 protected:
 	/** a component factory */
 	boost::scoped_ptr< Dataflow::ComponentFactory > m_pComponentFactory;
+
+	/** thread pool for push sink callbacks, must outlive the dataflow network */
+	boost::scoped_ptr< CallbackExecutor > m_pCallbackExecutor;
+
+	/** number of threads of the callback executor */
+	std::size_t m_nCallbackThreads;
 	
 	/** pointer to a dataflow network */
 	boost::shared_ptr< Dataflow::DataflowNetwork > m_pDataflowNetwork;
@@ -198,6 +291,9 @@ protected:
 	/** thread for the network */
 	boost::shared_ptr< boost::thread > m_pNetworkThread;
 
+	/** passes the callback executor to the push sinks created from \p doc */
+	void attachCallbackExecutor( Graph::UTQLDocument& doc );
+
 	/** handles a response from the ubitrack server */
 	void receiveUtqlResponse( boost::shared_ptr< Ubitrack::ClientServer::ClientServerConnection::BufferType > pBuffer );
 
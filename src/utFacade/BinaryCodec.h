@@ -0,0 +1,590 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Compact binary encoding of measurements for \c SimpleBinaryReceiver.
+ *
+ * Each measurement is encoded as a 16 byte header followed by a type-specific payload.
+ * All integers are unsigned little-endian unless noted, all floating point values are
+ * IEEE 754 doubles stored little-endian.
+ *
+ * Header:
+ * - byte 0: format version, \c SIMPLE_BINARY_VERSION
+ * - byte 1: measurement type, see \c SimpleBinaryType
+ * - bytes 2-3: reserved, 0
+ * - bytes 4-7: payload length in bytes, not including the header
+ * - bytes 8-15: timestamp in nanoseconds since the epoch, 0 on input means "now"
+ *
+ * Payload:
+ * - \c BINARY_BUTTON: signed 32 bit event
+ * - \c BINARY_DISTANCE: distance
+ * - \c BINARY_POSITION2D: x, y
+ * - \c BINARY_POSITION3D: x, y, z
+ * - \c BINARY_ROTATION: quaternion x, y, z, w
+ * - \c BINARY_POSE: tx, ty, tz, rx, ry, rz, rw
+ * - \c BINARY_ERROR_POSITION3D: x, y, z, 3x3 covariance
+ * - \c BINARY_ERROR_POSE: pose as above, 6x6 covariance
+ * - \c BINARY_MATRIX3X3, \c BINARY_MATRIX3X4, \c BINARY_MATRIX4X4: the matrix elements
+ * - list types: 32 bit element count followed by the elements encoded as above
+ *
+ * Matrices and covariances are stored row by row.
+ *
+ * Decoders accept payloads longer than expected and ignore the additional bytes, so
+ * later versions may append fields without changing \c SIMPLE_BINARY_VERSION.
+ */
+
+#ifndef __UBITRACK_FACADE_BINARYCODEC_H_INCLUDED__
+#define __UBITRACK_FACADE_BINARYCODEC_H_INCLUDED__
+
+#include <string.h>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <utUtil/Exception.h>
+#include <utMeasurement/Measurement.h>
+#include <utFacade/SimpleDatatypes.h>
+
+namespace Ubitrack { namespace Facade {
+
+/** appends little-endian values to a byte buffer */
+class BinaryWriter
+{
+public:
+	BinaryWriter( std::vector< unsigned char >& buffer )
+		: m_buffer( buffer )
+	{}
+
+	void writeU8( boost::uint8_t v )
+	{ m_buffer.push_back( v ); }
+
+	void writeU16( boost::uint16_t v )
+	{ writeBytes( v, 2 ); }
+
+	void writeU32( boost::uint32_t v )
+	{ writeBytes( v, 4 ); }
+
+	void writeI32( boost::int32_t v )
+	{ writeBytes( static_cast< boost::uint32_t >( v ), 4 ); }
+
+	void writeU64( boost::uint64_t v )
+	{ writeBytes( v, 8 ); }
+
+	void writeDouble( double v )
+	{
+		boost::uint64_t bits;
+		memcpy( &bits, &v, sizeof( bits ) );
+		writeBytes( bits, 8 );
+	}
+
+	/** writes the first \p n elements of a vector */
+	template< class VectorType >
+	void writeVector( const VectorType& v, unsigned int n )
+	{
+		for ( unsigned int i = 0; i < n; i++ )
+			writeDouble( v[ i ] );
+	}
+
+	/** writes a matrix row by row */
+	template< class MatrixType >
+	void writeMatrix( const MatrixType& m, unsigned int nRows, unsigned int nCols )
+	{
+		for ( unsigned int r = 0; r < nRows; r++ )
+			for ( unsigned int c = 0; c < nCols; c++ )
+				writeDouble( m( r, c ) );
+	}
+
+	/** overwrites a 32 bit value written before */
+	void patchU32( std::size_t offset, boost::uint32_t v )
+	{
+		for ( unsigned int i = 0; i < 4; i++ )
+			m_buffer[ offset + i ] = static_cast< unsigned char >( v >> ( 8 * i ) );
+	}
+
+	std::size_t size() const
+	{ return m_buffer.size(); }
+
+protected:
+	void writeBytes( boost::uint64_t v, unsigned int n )
+	{
+		for ( unsigned int i = 0; i < n; i++ )
+			m_buffer.push_back( static_cast< unsigned char >( v >> ( 8 * i ) ) );
+	}
+
+	std::vector< unsigned char >& m_buffer;
+};
+
+
+/** reads little-endian values from a byte buffer, throws if the buffer is too short */
+class BinaryReader
+{
+public:
+	BinaryReader( const void* pData, std::size_t nBytes )
+		: m_pData( static_cast< const unsigned char* >( pData ) )
+		, m_nRemaining( pData ? nBytes : 0 )
+	{}
+
+	boost::uint8_t readU8()
+	{ return static_cast< boost::uint8_t >( readBytes( 1 ) ); }
+
+	boost::uint16_t readU16()
+	{ return static_cast< boost::uint16_t >( readBytes( 2 ) ); }
+
+	boost::uint32_t readU32()
+	{ return static_cast< boost::uint32_t >( readBytes( 4 ) ); }
+
+	boost::int32_t readI32()
+	{ return static_cast< boost::int32_t >( static_cast< boost::uint32_t >( readBytes( 4 ) ) ); }
+
+	boost::uint64_t readU64()
+	{ return readBytes( 8 ); }
+
+	double readDouble()
+	{
+		boost::uint64_t bits( readBytes( 8 ) );
+		double v;
+		memcpy( &v, &bits, sizeof( v ) );
+		return v;
+	}
+
+	template< class VectorType >
+	void readVector( VectorType& v, unsigned int n )
+	{
+		for ( unsigned int i = 0; i < n; i++ )
+			v[ i ] = readDouble();
+	}
+
+	template< class MatrixType >
+	void readMatrix( MatrixType& m, unsigned int nRows, unsigned int nCols )
+	{
+		for ( unsigned int r = 0; r < nRows; r++ )
+			for ( unsigned int c = 0; c < nCols; c++ )
+				m( r, c ) = readDouble();
+	}
+
+	/**
+	 * Reads the element count of a list and checks that the buffer holds that many elements,
+	 * so that a corrupt count cannot cause a huge allocation.
+	 */
+	std::size_t readCount( std::size_t nElementBytes )
+	{
+		std::size_t n( readU32() );
+		if ( n > m_nRemaining / nElementBytes )
+			UBITRACK_THROW( "Binary measurement is truncated" );
+		return n;
+	}
+
+	/** restricts the reader to the next \p nBytes bytes */
+	void limit( std::size_t nBytes )
+	{
+		if ( nBytes > m_nRemaining )
+			UBITRACK_THROW( "Binary measurement is truncated" );
+		m_nRemaining = nBytes;
+	}
+
+protected:
+	boost::uint64_t readBytes( unsigned int n )
+	{
+		if ( m_nRemaining < n )
+			UBITRACK_THROW( "Binary measurement is truncated" );
+
+		boost::uint64_t v = 0;
+		for ( unsigned int i = 0; i < n; i++ )
+			v |= static_cast< boost::uint64_t >( m_pData[ i ] ) << ( 8 * i );
+		m_pData += n;
+		m_nRemaining -= n;
+		return v;
+	}
+
+	const unsigned char* m_pData;
+	std::size_t m_nRemaining;
+};
+
+
+/**
+ * Binary codec for measurement types without a binary encoding.
+ * \c ApplicationPushSink refuses binary callbacks for these types.
+ */
+template< class EventType >
+struct BinaryCodec
+{
+	static const bool s_bSupported = false;
+
+	static void encode( const EventType&, std::vector< unsigned char >& )
+	{}
+
+	static void decode( const void*, std::size_t, EventType& )
+	{ UBITRACK_THROW( "Measurement type has no binary encoding" ); }
+};
+
+
+/**
+ * Common part of the binary codecs, writes and checks the header.
+ * \p Codec provides \c s_type and the static payload functions
+ * <tt>write( BinaryWriter&, const EventType& )</tt> and
+ * <tt>read( BinaryReader&, Measurement::Timestamp )</tt>.
+ */
+template< class EventType, class Codec >
+struct BinaryCodecBase
+{
+	static const bool s_bSupported = true;
+
+	/** encodes a measurement, replacing the contents of \p buffer (but keeping its capacity) */
+	static void encode( const EventType& m, std::vector< unsigned char >& buffer )
+	{
+		buffer.clear();
+		BinaryWriter w( buffer );
+		w.writeU8( SIMPLE_BINARY_VERSION );
+		w.writeU8( Codec::s_type );
+		w.writeU16( 0 );
+		w.writeU32( 0 );
+		w.writeU64( m.time() );
+		Codec::write( w, m );
+		w.patchU32( 4, static_cast< boost::uint32_t >( w.size() - SIMPLE_BINARY_HEADER_SIZE ) );
+	}
+
+	/** decodes a measurement, throws a \c Util::Exception if the data is invalid */
+	static void decode( const void* pData, std::size_t nBytes, EventType& m )
+	{
+		BinaryReader r( pData, nBytes );
+		if ( r.readU8() != SIMPLE_BINARY_VERSION )
+			UBITRACK_THROW( "Unsupported binary measurement version" );
+		if ( r.readU8() != Codec::s_type )
+			UBITRACK_THROW( "Binary measurement has the wrong type" );
+		r.readU16();
+		boost::uint32_t nPayload( r.readU32() );
+		Measurement::Timestamp t( r.readU64() );
+		r.limit( nPayload );
+		m = Codec::read( r, t );
+	}
+};
+
+
+template<>
+struct BinaryCodec< Measurement::Button >
+	: public BinaryCodecBase< Measurement::Button, BinaryCodec< Measurement::Button > >
+{
+	static const unsigned char s_type = BINARY_BUTTON;
+
+	static void write( BinaryWriter& w, const Measurement::Button& m )
+	{ w.writeI32( *m ); }
+
+	static Measurement::Button read( BinaryReader& r, Measurement::Timestamp t )
+	{ return Measurement::Button( t, Math::Scalar< int >( r.readI32() ) ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::Distance >
+	: public BinaryCodecBase< Measurement::Distance, BinaryCodec< Measurement::Distance > >
+{
+	static const unsigned char s_type = BINARY_DISTANCE;
+
+	static void write( BinaryWriter& w, const Measurement::Distance& m )
+	{ w.writeDouble( *m ); }
+
+	static Measurement::Distance read( BinaryReader& r, Measurement::Timestamp t )
+	{ return Measurement::Distance( t, Math::Scalar< double >( r.readDouble() ) ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::Position2D >
+	: public BinaryCodecBase< Measurement::Position2D, BinaryCodec< Measurement::Position2D > >
+{
+	static const unsigned char s_type = BINARY_POSITION2D;
+
+	static void write( BinaryWriter& w, const Measurement::Position2D& m )
+	{ w.writeVector( *m, 2 ); }
+
+	static Measurement::Position2D read( BinaryReader& r, Measurement::Timestamp t )
+	{
+		Math::Vector< double, 2 > v;
+		r.readVector( v, 2 );
+		return Measurement::Position2D( t, v );
+	}
+};
+
+template<>
+struct BinaryCodec< Measurement::Position >
+	: public BinaryCodecBase< Measurement::Position, BinaryCodec< Measurement::Position > >
+{
+	static const unsigned char s_type = BINARY_POSITION3D;
+
+	static void write( BinaryWriter& w, const Measurement::Position& m )
+	{ w.writeVector( *m, 3 ); }
+
+	static Measurement::Position read( BinaryReader& r, Measurement::Timestamp t )
+	{
+		Math::Vector< double, 3 > v;
+		r.readVector( v, 3 );
+		return Measurement::Position( t, v );
+	}
+};
+
+template<>
+struct BinaryCodec< Measurement::Rotation >
+	: public BinaryCodecBase< Measurement::Rotation, BinaryCodec< Measurement::Rotation > >
+{
+	static const unsigned char s_type = BINARY_ROTATION;
+
+	static void writeQuaternion( BinaryWriter& w, const Math::Quaternion& q )
+	{
+		w.writeDouble( q.x() );
+		w.writeDouble( q.y() );
+		w.writeDouble( q.z() );
+		w.writeDouble( q.w() );
+	}
+
+	static Math::Quaternion readQuaternion( BinaryReader& r )
+	{
+		double x( r.readDouble() );
+		double y( r.readDouble() );
+		double z( r.readDouble() );
+		double w( r.readDouble() );
+		return Math::Quaternion( x, y, z, w );
+	}
+
+	static void write( BinaryWriter& w, const Measurement::Rotation& m )
+	{ writeQuaternion( w, *m ); }
+
+	static Measurement::Rotation read( BinaryReader& r, Measurement::Timestamp t )
+	{ return Measurement::Rotation( t, readQuaternion( r ) ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::Pose >
+	: public BinaryCodecBase< Measurement::Pose, BinaryCodec< Measurement::Pose > >
+{
+	static const unsigned char s_type = BINARY_POSE;
+	static const std::size_t s_nBytes = 7 * 8;
+
+	static void writePose( BinaryWriter& w, const Math::Pose& p )
+	{
+		w.writeVector( p.translation(), 3 );
+		BinaryCodec< Measurement::Rotation >::writeQuaternion( w, p.rotation() );
+	}
+
+	static Math::Pose readPose( BinaryReader& r )
+	{
+		Math::Vector< double, 3 > t;
+		r.readVector( t, 3 );
+		return Math::Pose( BinaryCodec< Measurement::Rotation >::readQuaternion( r ), t );
+	}
+
+	static void write( BinaryWriter& w, const Measurement::Pose& m )
+	{ writePose( w, *m ); }
+
+	static Measurement::Pose read( BinaryReader& r, Measurement::Timestamp t )
+	{ return Measurement::Pose( t, readPose( r ) ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::ErrorPosition >
+	: public BinaryCodecBase< Measurement::ErrorPosition, BinaryCodec< Measurement::ErrorPosition > >
+{
+	static const unsigned char s_type = BINARY_ERROR_POSITION3D;
+	static const std::size_t s_nBytes = 12 * 8;
+
+	static void writeValue( BinaryWriter& w, const Math::ErrorVector< double, 3 >& v )
+	{
+		w.writeVector( v.value, 3 );
+		w.writeMatrix( v.covariance, 3, 3 );
+	}
+
+	static Math::ErrorVector< double, 3 > readValue( BinaryReader& r )
+	{
+		Math::Vector< double, 3 > v;
+		Math::Matrix< double, 3, 3 > cov;
+		r.readVector( v, 3 );
+		r.readMatrix( cov, 3, 3 );
+		return Math::ErrorVector< double, 3 >( v, cov );
+	}
+
+	static void write( BinaryWriter& w, const Measurement::ErrorPosition& m )
+	{ writeValue( w, *m ); }
+
+	static Measurement::ErrorPosition read( BinaryReader& r, Measurement::Timestamp t )
+	{ return Measurement::ErrorPosition( t, readValue( r ) ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::ErrorPose >
+	: public BinaryCodecBase< Measurement::ErrorPose, BinaryCodec< Measurement::ErrorPose > >
+{
+	static const unsigned char s_type = BINARY_ERROR_POSE;
+
+	static void write( BinaryWriter& w, const Measurement::ErrorPose& m )
+	{
+		BinaryCodec< Measurement::Pose >::writePose( w, *m );
+		w.writeMatrix( m->covariance(), 6, 6 );
+	}
+
+	static Measurement::ErrorPose read( BinaryReader& r, Measurement::Timestamp t )
+	{
+		Math::Pose p( BinaryCodec< Measurement::Pose >::readPose( r ) );
+		Math::Matrix< double, 6, 6 > cov;
+		r.readMatrix( cov, 6, 6 );
+		return Measurement::ErrorPose( t, Math::ErrorPose( p.rotation(), p.translation(), cov ) );
+	}
+};
+
+/** codec for the matrix measurements */
+template< class EventType, unsigned char Type, unsigned int Rows, unsigned int Cols >
+struct BinaryMatrixCodec
+	: public BinaryCodecBase< EventType, BinaryMatrixCodec< EventType, Type, Rows, Cols > >
+{
+	static const unsigned char s_type = Type;
+
+	static void write( BinaryWriter& w, const EventType& m )
+	{ w.writeMatrix( *m, Rows, Cols ); }
+
+	static EventType read( BinaryReader& r, Measurement::Timestamp t )
+	{
+		boost::shared_ptr< typename EventType::value_type > pMatrix( new typename EventType::value_type );
+		r.readMatrix( *pMatrix, Rows, Cols );
+		return EventType( t, pMatrix );
+	}
+};
+
+template<>
+struct BinaryCodec< Measurement::Matrix3x3 >
+	: public BinaryMatrixCodec< Measurement::Matrix3x3, BINARY_MATRIX3X3, 3, 3 >
+{};
+
+template<>
+struct BinaryCodec< Measurement::Matrix3x4 >
+	: public BinaryMatrixCodec< Measurement::Matrix3x4, BINARY_MATRIX3X4, 3, 4 >
+{};
+
+template<>
+struct BinaryCodec< Measurement::Matrix4x4 >
+	: public BinaryMatrixCodec< Measurement::Matrix4x4, BINARY_MATRIX4X4, 4, 4 >
+{};
+
+/**
+ * Codec for list measurements. \p Element provides the static functions
+ * \c writeValue and \c readValue and the encoded size \c s_nBytes of a single element.
+ */
+template< class EventType, unsigned char Type, class Element >
+struct BinaryListCodec
+	: public BinaryCodecBase< EventType, BinaryListCodec< EventType, Type, Element > >
+{
+	static const unsigned char s_type = Type;
+
+	static void write( BinaryWriter& w, const EventType& m )
+	{
+		const std::size_t count( m->size() );
+		w.writeU32( static_cast< boost::uint32_t >( count ) );
+		for ( std::size_t i = 0; i < count; i++ )
+			Element::writeValue( w, ( *m )[ i ] );
+	}
+
+	static EventType read( BinaryReader& r, Measurement::Timestamp t )
+	{
+		const std::size_t count( r.readCount( Element::s_nBytes ) );
+		boost::shared_ptr< typename EventType::value_type > pList( new typename EventType::value_type );
+		pList->reserve( count );
+		for ( std::size_t i = 0; i < count; i++ )
+			pList->push_back( Element::readValue( r ) );
+		return EventType( t, pList );
+	}
+};
+
+/** list element codec for vectors */
+template< unsigned int N >
+struct BinaryVectorElement
+{
+	static const std::size_t s_nBytes = N * 8;
+
+	static void writeValue( BinaryWriter& w, const Math::Vector< double, N >& v )
+	{ w.writeVector( v, N ); }
+
+	static Math::Vector< double, N > readValue( BinaryReader& r )
+	{
+		Math::Vector< double, N > v;
+		r.readVector( v, N );
+		return v;
+	}
+};
+
+/** list element codec for 2D error vectors */
+struct BinaryErrorVector2Element
+{
+	static const std::size_t s_nBytes = 6 * 8;
+
+	static void writeValue( BinaryWriter& w, const Math::ErrorVector< double, 2 >& v )
+	{
+		w.writeVector( v.value, 2 );
+		w.writeMatrix( v.covariance, 2, 2 );
+	}
+
+	static Math::ErrorVector< double, 2 > readValue( BinaryReader& r )
+	{
+		Math::Vector< double, 2 > v;
+		Math::Matrix< double, 2, 2 > cov;
+		r.readVector( v, 2 );
+		r.readMatrix( cov, 2, 2 );
+		return Math::ErrorVector< double, 2 >( v, cov );
+	}
+};
+
+/** list element codec for poses */
+struct BinaryPoseElement
+{
+	static const std::size_t s_nBytes = BinaryCodec< Measurement::Pose >::s_nBytes;
+
+	static void writeValue( BinaryWriter& w, const Math::Pose& p )
+	{ BinaryCodec< Measurement::Pose >::writePose( w, p ); }
+
+	static Math::Pose readValue( BinaryReader& r )
+	{ return BinaryCodec< Measurement::Pose >::readPose( r ); }
+};
+
+template<>
+struct BinaryCodec< Measurement::PositionList2 >
+	: public BinaryListCodec< Measurement::PositionList2, BINARY_POSITION2D_LIST, BinaryVectorElement< 2 > >
+{};
+
+template<>
+struct BinaryCodec< Measurement::PositionList >
+	: public BinaryListCodec< Measurement::PositionList, BINARY_POSITION3D_LIST, BinaryVectorElement< 3 > >
+{};
+
+template<>
+struct BinaryCodec< Measurement::ErrorPositionList2 >
+	: public BinaryListCodec< Measurement::ErrorPositionList2, BINARY_ERROR_POSITION2D_LIST, BinaryErrorVector2Element >
+{};
+
+template<>
+struct BinaryCodec< Measurement::ErrorPositionList >
+	: public BinaryListCodec< Measurement::ErrorPositionList, BINARY_ERROR_POSITION3D_LIST, BinaryCodec< Measurement::ErrorPosition > >
+{};
+
+template<>
+struct BinaryCodec< Measurement::PoseList >
+	: public BinaryListCodec< Measurement::PoseList, BINARY_POSE_LIST, BinaryPoseElement >
+{};
+
+} } // namespace Ubitrack::Facade
+
+#endif // __UBITRACK_FACADE_BINARYCODEC_H_INCLUDED__
@@ -0,0 +1,130 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Implements the thread pool for the callbacks of application push sinks.
+ */
+
+#include <boost/bind.hpp>
+#include <log4cpp/Category.hh>
+#include <utUtil/Exception.h>
+
+#include "CallbackExecutor.h"
+
+// get a logger
+static log4cpp::Category& logger( log4cpp::Category::getInstance( "Ubitrack.Facade.CallbackExecutor" ) );
+
+namespace Ubitrack { namespace Facade {
+
+CallbackExecutor::CallbackExecutor( std::size_t nThreads )
+	: m_bStop( false )
+	, m_bFinishTasks( false )
+{
+	resize( nThreads );
+}
+
+
+CallbackExecutor::~CallbackExecutor()
+{
+	stopThreads( true );
+}
+
+
+void CallbackExecutor::schedule( Components::ApplicationPushSinkBase* pSink )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_tasks.push_back( pSink );
+	m_condition.notify_one();
+}
+
+
+void CallbackExecutor::resize( std::size_t nThreads )
+{
+	if ( nThreads < 1 )
+		UBITRACK_THROW( "CallbackExecutor needs at least one thread" );
+
+	LOG4CPP_DEBUG( logger, "Resizing callback executor to " << nThreads << " threads" );
+
+	stopThreads( false );
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_bStop = false;
+	}
+	for ( std::size_t i = 0; i < nThreads; i++ )
+		m_threads.push_back( boost::shared_ptr< boost::thread >( 
+			new boost::thread( boost::bind( &CallbackExecutor::workerThread, this ) ) ) );
+}
+
+
+void CallbackExecutor::stopThreads( bool bFinishTasks )
+{
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_bStop = true;
+		m_bFinishTasks = bFinishTasks;
+		m_condition.notify_all();
+	}
+
+	for ( std::size_t i = 0; i < m_threads.size(); i++ )
+		m_threads[ i ]->join();
+	m_threads.clear();
+}
+
+
+void CallbackExecutor::workerThread()
+{
+	while ( true )
+	{
+		Components::ApplicationPushSinkBase* pSink;
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			while ( m_tasks.empty() && !m_bStop )
+				m_condition.wait( lock );
+
+			if ( m_bStop && ( m_tasks.empty() || !m_bFinishTasks ) )
+				return;
+
+			pSink = m_tasks.front();
+			m_tasks.pop_front();
+		}
+
+		try
+		{
+			pSink->runExecutorTask();
+		}
+		catch ( const std::exception& e )
+		{
+			LOG4CPP_ERROR( logger, "Caught exception in push sink callback: " << e.what() );
+		}
+		catch ( ... )
+		{
+			// e.g. from a SWIG director, the worker must survive it
+			LOG4CPP_ERROR( logger, "Caught unknown exception in push sink callback" );
+		}
+	}
+}
+
+} } // namespace Ubitrack::Facade
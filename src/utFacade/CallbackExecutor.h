@@ -0,0 +1,97 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Thread pool for the callbacks of application push sinks.
+ */
+
+#ifndef __UBITRACK_FACADE_CALLBACKEXECUTOR_H_INCLUDED__
+#define __UBITRACK_FACADE_CALLBACKEXECUTOR_H_INCLUDED__
+
+#include <deque>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "../utComponents/ApplicationPushSink.h"
+
+namespace Ubitrack { namespace Facade {
+
+/**
+ * Small thread pool that runs the tasks of push sinks in \c executor delivery mode.
+ * Each sink has at most one task pending, so the pool needs no further ordering.
+ */
+class CallbackExecutor
+	: public Components::ApplicationPushSinkExecutor
+{
+public:
+	/** starts \p nThreads worker threads */
+	CallbackExecutor( std::size_t nThreads );
+
+	/** runs the remaining tasks and joins the worker threads */
+	~CallbackExecutor();
+
+	/** @copydoc Components::ApplicationPushSinkExecutor::schedule */
+	void schedule( Components::ApplicationPushSinkBase* pSink );
+
+	/** 
+	 * Changes the number of worker threads.
+	 * Waits for running tasks to finish, pending tasks are kept.
+	 */
+	void resize( std::size_t nThreads );
+
+	/** returns the number of worker threads */
+	std::size_t size() const
+	{ return m_threads.size(); }
+
+protected:
+	/** main loop of the worker threads */
+	void workerThread();
+
+	/** stops and joins all worker threads */
+	void stopThreads( bool bFinishTasks );
+
+	/** tasks waiting for a worker */
+	std::deque< Components::ApplicationPushSinkBase* > m_tasks;
+
+	/** protects the task list and the stop flags */
+	boost::mutex m_mutex;
+
+	/** signalled when a task is added or the threads should stop */
+	boost::condition_variable m_condition;
+
+	/** tells the worker threads to exit */
+	bool m_bStop;
+
+	/** tells the worker threads to run all pending tasks before exiting */
+	bool m_bFinishTasks;
+
+	/** the worker threads */
+	std::vector< boost::shared_ptr< boost::thread > > m_threads;
+};
+
+} } // namespace Ubitrack::Facade
+
+#endif
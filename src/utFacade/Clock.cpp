@@ -0,0 +1,264 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Implements the time stamp counter clock of the facade.
+ */
+
+#include <time.h>
+#include <fstream>
+#include <string>
+#include <boost/atomic.hpp>
+#include <log4cpp/Category.hh>
+
+#include <utMeasurement/Measurement.h>
+#include "../utComponents/SeqlockSlot.h"
+#include "Clock.h"
+
+#if defined( __linux__ ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#	define UTFACADE_HAVE_TSC
+#	include <cpuid.h>
+#	include <x86intrin.h>
+#endif
+
+// get a logger
+static log4cpp::Category& clockLogger( log4cpp::Category::getInstance( "Ubitrack.Facade.Clock" ) );
+
+namespace Ubitrack { namespace Facade { namespace Clock {
+
+namespace {
+
+/** reads the system clock */
+unsigned long long systemNow()
+{
+#ifdef __linux__
+	struct timespec ts;
+	clock_gettime( CLOCK_REALTIME, &ts );
+	return static_cast< unsigned long long >( ts.tv_sec ) * 1000000000ULL + ts.tv_nsec;
+#else
+	return Measurement::now();
+#endif
+}
+
+#ifdef UTFACADE_HAVE_TSC
+
+/** conversion from TSC ticks to nanoseconds: ns = ns0 + ( tsc - tsc0 ) * nsPerTick */
+struct Calibration
+{
+	unsigned long long tsc0;
+	unsigned long long ns0;
+	double nsPerTick;
+
+	/** TSC value after which the next correction is due */
+	unsigned long long nextCorrection;
+};
+
+/** interval between corrections */
+const unsigned long long g_nCorrectionIntervalNs = 1000000000ULL;
+
+/** larger offsets to the system clock are applied at once instead of slewing */
+const long long g_nMaxSlewNs = 1000000LL;
+
+/** duration of the initial calibration */
+const unsigned long long g_nInitialCalibrationNs = 5000000ULL;
+
+class TscClock
+{
+public:
+	TscClock()
+		: m_bUseTsc( false )
+		, m_bCorrecting( false )
+	{
+		// may run before clockLogger is initialized if another static initializer calls now()
+		log4cpp::Category& logger( log4cpp::Category::getInstance( "Ubitrack.Facade.Clock" ) );
+		if ( !tscUsable() )
+		{
+			LOG4CPP_INFO( logger, "Time stamp counter not invariant or not used by the kernel, using clock_gettime" );
+			return;
+		}
+
+		// measure the TSC frequency by busy waiting
+		sample( m_baseTsc, m_baseNs );
+		unsigned long long tsc, ns;
+		do
+			sample( tsc, ns );
+		while ( ns - m_baseNs < g_nInitialCalibrationNs );
+
+		Calibration c;
+		c.tsc0 = tsc;
+		c.ns0 = ns;
+		c.nsPerTick = static_cast< double >( ns - m_baseNs ) / static_cast< double >( tsc - m_baseTsc );
+		c.nextCorrection = tsc + static_cast< unsigned long long >( g_nCorrectionIntervalNs / c.nsPerTick );
+		m_calibration.write( c );
+		m_bUseTsc = true;
+
+		LOG4CPP_INFO( logger, "Using the time stamp counter at " << 1.0 / c.nsPerTick << " GHz" );
+	}
+
+	bool useTsc() const
+	{ return m_bUseTsc; }
+
+	unsigned long long now()
+	{
+		Calibration c;
+		m_calibration.read( c );
+		unsigned long long tsc = __rdtsc();
+		if ( tsc >= c.nextCorrection )
+			correct( c );
+		return c.ns0 + static_cast< long long >( static_cast< double >( static_cast< long long >( tsc - c.tsc0 ) ) * c.nsPerTick );
+	}
+
+protected:
+	/** checks CPUID for an invariant TSC and that the kernel trusts it as clocksource */
+	static bool tscUsable()
+	{
+		unsigned int eax, ebx, ecx, edx;
+		if ( !__get_cpuid( 0x80000000, &eax, &ebx, &ecx, &edx ) || eax < 0x80000007 )
+			return false;
+		__get_cpuid( 0x80000007, &eax, &ebx, &ecx, &edx );
+		if ( !( edx & ( 1 << 8 ) ) )
+			return false;
+
+		std::ifstream f( "/sys/devices/system/clocksource/clocksource0/current_clocksource" );
+		std::string sSource;
+		return f >> sSource && sSource == "tsc";
+	}
+
+	/** reads the system clock and the TSC at the same moment, using the tightest of a few tries */
+	static void sample( unsigned long long& tsc, unsigned long long& ns )
+	{
+		unsigned long long nBest = ~0ULL;
+		for ( int i = 0; i < 5; i++ )
+		{
+			unsigned long long before = __rdtsc();
+			unsigned long long t = systemNow();
+			unsigned long long after = __rdtsc();
+			if ( after - before < nBest )
+			{
+				nBest = after - before;
+				tsc = before + ( after - before ) / 2;
+				ns = t;
+			}
+		}
+	}
+
+	/**
+	 * Recomputes the rate from the whole time since the start and chooses the slope for the
+	 * next interval so that the clock meets the system clock at its end. Done by the first
+	 * thread that notices the correction is due; the others continue with the newest
+	 * published values, which are the old ones until the correction is written.
+	 */
+	void correct( Calibration& c )
+	{
+		if ( m_bCorrecting.exchange( true, boost::memory_order_acquire ) )
+		{
+			m_calibration.read( c );
+			return;
+		}
+
+		Calibration current;
+		m_calibration.read( current );
+		if ( current.nextCorrection == c.nextCorrection )
+		{
+			unsigned long long tsc, ns;
+			sample( tsc, ns );
+
+			double nsPerTick = static_cast< double >( ns - m_baseNs ) / static_cast< double >( tsc - m_baseTsc );
+			unsigned long long nIntervalTicks = static_cast< unsigned long long >( g_nCorrectionIntervalNs / nsPerTick );
+			long long nOurs = static_cast< long long >( c.ns0 + static_cast< long long >( static_cast< double >( static_cast< long long >( tsc - c.tsc0 ) ) * c.nsPerTick ) );
+			long long nOffset = static_cast< long long >( ns ) - nOurs;
+
+			Calibration next;
+			next.tsc0 = tsc;
+			next.nextCorrection = tsc + nIntervalTicks;
+			if ( nOffset > g_nMaxSlewNs || nOffset < -g_nMaxSlewNs )
+			{
+				LOG4CPP_DEBUG( clockLogger, "Clock offset of " << nOffset << " ns, stepping" );
+				next.ns0 = ns;
+				next.nsPerTick = nsPerTick;
+			}
+			else
+			{
+				next.ns0 = nOurs;
+				next.nsPerTick = ( g_nCorrectionIntervalNs + nOffset ) / static_cast< double >( nIntervalTicks );
+			}
+			m_calibration.write( next );
+			c = next;
+		}
+		else
+			c = current;
+
+		m_bCorrecting.store( false, boost::memory_order_release );
+	}
+
+	bool m_bUseTsc;
+
+	/** first calibration sample, the rate is measured against it */
+	unsigned long long m_baseTsc;
+	unsigned long long m_baseNs;
+
+	Components::SeqlockSlot< Calibration > m_calibration;
+	boost::atomic< bool > m_bCorrecting;
+};
+
+TscClock& tscClock()
+{
+	// constructed on first use, also when called from other static initializers
+	static TscClock clock;
+	return clock;
+}
+
+/** calibrates when the library is loaded, not on the first call */
+struct CalibrateOnLoad
+{
+	CalibrateOnLoad()
+	{ tscClock(); }
+} g_calibrateOnLoad;
+
+#endif // UTFACADE_HAVE_TSC
+
+} // anonymous namespace
+
+
+unsigned long long now()
+{
+#ifdef UTFACADE_HAVE_TSC
+	TscClock& clock( tscClock() );
+	if ( clock.useTsc() )
+		return clock.now();
+#endif
+	return systemNow();
+}
+
+bool usesTsc()
+{
+#ifdef UTFACADE_HAVE_TSC
+	return tscClock().useTsc();
+#else
+	return false;
+#endif
+}
+
+} } } // namespace Ubitrack::Facade::Clock
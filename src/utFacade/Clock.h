@@ -0,0 +1,61 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Low-overhead wall clock for timestamping measurements.
+ *
+ * On x86 Linux systems with an invariant time stamp counter that the kernel also uses as
+ * its clocksource, the clock reads the TSC and converts it to nanoseconds since the unix
+ * epoch. The conversion is calibrated against CLOCK_REALTIME when the library is loaded
+ * and corrected about once per second by slewing towards CLOCK_REALTIME, so the clock
+ * follows NTP adjustments without jumping. Offsets of more than a millisecond (e.g. when
+ * the system time was set) are applied at once.
+ *
+ * Readings are not strictly monotonic across threads around a correction: a thread that
+ * read the calibration just before it was replaced converts with the old slope for a
+ * moment, while others already use the new one. The slopes differ by at most 0.1 %, so
+ * such a reading can be earlier than one taken before it on another thread by about
+ * 0.1 % of the time since the correction was due, a few nanoseconds in practice.
+ * The clock section of utBenchmark measures this. Steps are not monotonic at all.
+ *
+ * On all other systems the clock calls clock_gettime or \c Measurement::now().
+ */
+
+#ifndef __UBITRACK_FACADE_CLOCK_H_INCLUDED__
+#define __UBITRACK_FACADE_CLOCK_H_INCLUDED__
+
+#include <utFacade/utFacade.h>
+
+namespace Ubitrack { namespace Facade { namespace Clock {
+
+/** returns the current time in nanoseconds since the unix epoch, like \c Measurement::now() */
+UTFACADE_EXPORT unsigned long long now();
+
+/** returns true if the clock reads the time stamp counter, false if it uses the system clock */
+UTFACADE_EXPORT bool usesTsc();
+
+} } } // namespace Ubitrack::Facade::Clock
+
+#endif // __UBITRACK_FACADE_CLOCK_H_INCLUDED__
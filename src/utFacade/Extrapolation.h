@@ -0,0 +1,171 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Constant velocity prediction of the simple datatypes, used by the pull sink proxies
+ * to compensate the latency of the display.
+ */
+
+#ifndef __UBITRACK_FACADE_EXTRAPOLATION_H_INCLUDED__
+#define __UBITRACK_FACADE_EXTRAPOLATION_H_INCLUDED__
+
+#include <math.h>
+#include "SimpleDatatypes.h"
+
+namespace Ubitrack { namespace Facade {
+
+/**
+ * Fits the velocity of a scalar through the newest value by least squares.
+ * @param pTau times of the history relative to the newest value in seconds
+ * @param pDelta values of the history minus the newest value
+ */
+inline double fitVelocity( const double* pTau, const double* pDelta, unsigned int nCount )
+{
+	double num = 0.0;
+	double den = 0.0;
+	for ( unsigned int i = 0; i < nCount; i++ )
+	{
+		num += pDelta[ i ] * pTau[ i ];
+		den += pTau[ i ] * pTau[ i ];
+	}
+	return den > 0.0 ? num / den : 0.0;
+}
+
+/** signed time difference of \p t to \p latest in seconds */
+inline double timeDifference( unsigned long long int t, unsigned long long int latest )
+{
+	return t >= latest ? ( t - latest ) * 1e-9 : -( ( latest - t ) * 1e-9 );
+}
+
+/**
+ * Predicts a position for timestamp \p t from the newest measurement and older ones,
+ * assuming constant velocity. The velocity is fitted through the newest measurement,
+ * so the prediction starts exactly at it.
+ *
+ * @param pHistory older measurements
+ * @param nCount number of entries in \p pHistory
+ * @param latest the newest measurement
+ * @param t the timestamp to predict
+ * @param result receives the prediction, may be the same object as \p latest
+ */
+inline void extrapolate( const SimplePosition3D* pHistory, unsigned int nCount, const SimplePosition3D& latest,
+	unsigned long long int t, SimplePosition3D& result )
+{
+	const unsigned int nMax = 8;
+	if ( nCount > nMax )
+		nCount = nMax;
+
+	double tau[ nMax ];
+	double delta[ 3 ][ nMax ];
+	for ( unsigned int i = 0; i < nCount; i++ )
+	{
+		tau[ i ] = timeDifference( pHistory[ i ].timestamp, latest.timestamp );
+		delta[ 0 ][ i ] = pHistory[ i ].x - latest.x;
+		delta[ 1 ][ i ] = pHistory[ i ].y - latest.y;
+		delta[ 2 ][ i ] = pHistory[ i ].z - latest.z;
+	}
+
+	const double h = timeDifference( t, latest.timestamp );
+	const double x = latest.x + h * fitVelocity( tau, delta[ 0 ], nCount );
+	const double y = latest.y + h * fitVelocity( tau, delta[ 1 ], nCount );
+	const double z = latest.z + h * fitVelocity( tau, delta[ 2 ], nCount );
+	result.x = x;
+	result.y = y;
+	result.z = z;
+	result.timestamp = t;
+}
+
+/**
+ * Predicts a pose for timestamp \p t like the position variant, with constant velocity
+ * for the translation and constant angular velocity for the rotation. The angular
+ * velocity is fitted to the rotations from the newest pose to the older ones.
+ */
+inline void extrapolate( const SimplePose* pHistory, unsigned int nCount, const SimplePose& latest,
+	unsigned long long int t, SimplePose& result )
+{
+	const unsigned int nMax = 8;
+	if ( nCount > nMax )
+		nCount = nMax;
+
+	double tau[ nMax ];
+	double delta[ 6 ][ nMax ];
+	for ( unsigned int i = 0; i < nCount; i++ )
+	{
+		const SimplePose& p( pHistory[ i ] );
+		tau[ i ] = timeDifference( p.timestamp, latest.timestamp );
+		delta[ 0 ][ i ] = p.tx - latest.tx;
+		delta[ 1 ][ i ] = p.ty - latest.ty;
+		delta[ 2 ][ i ] = p.tz - latest.tz;
+
+		// q = p * conj( latest ), the rotation from the newest pose to the older one, on the shorter arc
+		double qx =  p.rw * -latest.rx + p.rx *  latest.rw + p.ry * -latest.rz - p.rz * -latest.ry;
+		double qy =  p.rw * -latest.ry - p.rx * -latest.rz + p.ry *  latest.rw + p.rz * -latest.rx;
+		double qz =  p.rw * -latest.rz + p.rx * -latest.ry - p.ry * -latest.rx + p.rz *  latest.rw;
+		double qw =  p.rw *  latest.rw - p.rx * -latest.rx - p.ry * -latest.ry - p.rz * -latest.rz;
+		if ( qw < 0.0 )
+		{
+			qx = -qx; qy = -qy; qz = -qz; qw = -qw;
+		}
+
+		// rotation vector of q
+		double s = sqrt( qx * qx + qy * qy + qz * qz );
+		double f = s > 1e-12 ? 2.0 * atan2( s, qw ) / s : 2.0;
+		delta[ 3 ][ i ] = f * qx;
+		delta[ 4 ][ i ] = f * qy;
+		delta[ 5 ][ i ] = f * qz;
+	}
+
+	const double h = timeDifference( t, latest.timestamp );
+	double v[ 6 ];
+	for ( int j = 0; j < 6; j++ )
+		v[ j ] = h * fitVelocity( tau, delta[ j ], nCount );
+
+	// r = exp( rotation vector ) * latest
+	double angle = sqrt( v[ 3 ] * v[ 3 ] + v[ 4 ] * v[ 4 ] + v[ 5 ] * v[ 5 ] );
+	double f = angle > 1e-12 ? sin( 0.5 * angle ) / angle : 0.5;
+	const double ex = f * v[ 3 ];
+	const double ey = f * v[ 4 ];
+	const double ez = f * v[ 5 ];
+	const double ew = cos( 0.5 * angle );
+
+	double rx = ew * latest.rx + ex * latest.rw + ey * latest.rz - ez * latest.ry;
+	double ry = ew * latest.ry - ex * latest.rz + ey * latest.rw + ez * latest.rx;
+	double rz = ew * latest.rz + ex * latest.ry - ey * latest.rx + ez * latest.rw;
+	double rw = ew * latest.rw - ex * latest.rx - ey * latest.ry - ez * latest.rz;
+	double n = sqrt( rx * rx + ry * ry + rz * rz + rw * rw );
+
+	result.tx = latest.tx + v[ 0 ];
+	result.ty = latest.ty + v[ 1 ];
+	result.tz = latest.tz + v[ 2 ];
+	result.rx = rx / n;
+	result.ry = ry / n;
+	result.rz = rz / n;
+	result.rw = rw / n;
+	result.timestamp = t;
+}
+
+} } // namespace Ubitrack::Facade
+
+#endif // __UBITRACK_FACADE_EXTRAPOLATION_H_INCLUDED__
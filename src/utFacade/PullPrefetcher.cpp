@@ -0,0 +1,112 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Implements the background thread for prefetching pulls.
+ */
+
+#include <boost/bind.hpp>
+#include <log4cpp/Category.hh>
+
+#include "PullPrefetcher.h"
+
+// get a logger
+static log4cpp::Category& logger( log4cpp::Category::getInstance( "Ubitrack.Facade.PullPrefetcher" ) );
+
+namespace Ubitrack { namespace Facade {
+
+PullPrefetcher::PullPrefetcher()
+	: m_bStop( false )
+{}
+
+
+PullPrefetcher::~PullPrefetcher()
+{
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_bStop = true;
+		m_condition.notify_all();
+	}
+
+	if ( m_pThread )
+		m_pThread->join();
+}
+
+
+void PullPrefetcher::request( PrefetchTarget* pTarget, unsigned long long t )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	if ( !m_pThread )
+	{
+		LOG4CPP_DEBUG( logger, "Starting pull prefetcher thread" );
+		m_pThread.reset( new boost::thread( boost::bind( &PullPrefetcher::workerThread, this ) ) );
+	}
+
+	m_requests[ t ].push_back( pTarget );
+	m_condition.notify_one();
+}
+
+
+void PullPrefetcher::workerThread()
+{
+	std::vector< PrefetchTarget* > targets;
+	while ( true )
+	{
+		unsigned long long t;
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			while ( m_requests.empty() && !m_bStop )
+				m_condition.wait( lock );
+
+			if ( m_bStop )
+				return;
+
+			RequestMap::iterator it( m_requests.begin() );
+			t = it->first;
+			targets.swap( it->second );
+			m_requests.erase( it );
+		}
+
+		for ( std::size_t i = 0; i < targets.size(); i++ )
+		{
+			try
+			{
+				targets[ i ]->prefetch( t );
+			}
+			catch ( const std::exception& e )
+			{
+				LOG4CPP_ERROR( logger, "Caught exception in prefetching pull: " << e.what() );
+			}
+			catch ( ... )
+			{
+				// the worker serves all proxies and must survive it
+				LOG4CPP_ERROR( logger, "Caught unknown exception in prefetching pull" );
+			}
+		}
+		targets.clear();
+	}
+}
+
+} } // namespace Ubitrack::Facade
@@ -0,0 +1,92 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Background thread that pulls measurements for timestamps requested in advance.
+ */
+
+#ifndef __UBITRACK_FACADE_PULLPREFETCHER_H_INCLUDED__
+#define __UBITRACK_FACADE_PULLPREFETCHER_H_INCLUDED__
+
+#include <map>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+
+namespace Ubitrack { namespace Facade {
+
+/** something the PullPrefetcher can pull for */
+class PrefetchTarget
+{
+public:
+	/** pulls the measurement for timestamp \p t and stores the result, called by the worker thread */
+	virtual void prefetch( unsigned long long t ) = 0;
+
+	/** virtual destructor */
+	virtual ~PrefetchTarget()
+	{}
+};
+
+/**
+ * Runs the requestPose calls of the pull sink proxies on a single worker thread.
+ * Requests are grouped by timestamp, so all sinks requested for the same frame are
+ * pulled one after the other in one wakeup, oldest timestamp first.
+ * The thread is started with the first request.
+ */
+class PullPrefetcher
+{
+public:
+	PullPrefetcher();
+
+	/** drops the pending requests and joins the worker thread */
+	~PullPrefetcher();
+
+	/** schedules a pull of \p pTarget for timestamp \p t */
+	void request( PrefetchTarget* pTarget, unsigned long long t );
+
+protected:
+	/** main loop of the worker thread */
+	void workerThread();
+
+	/** pending requests by timestamp */
+	typedef std::map< unsigned long long, std::vector< PrefetchTarget* > > RequestMap;
+	RequestMap m_requests;
+
+	/** protects the requests and the stop flag */
+	boost::mutex m_mutex;
+
+	/** signalled when a request is added or the thread should stop */
+	boost::condition_variable m_condition;
+
+	/** tells the worker thread to exit */
+	bool m_bStop;
+
+	/** the worker thread */
+	boost::scoped_ptr< boost::thread > m_pThread;
+};
+
+} } // namespace Ubitrack::Facade
+
+#endif
@@ -0,0 +1,295 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Shared-memory ring for feeding an \c ApplicationShmPushSource from another process.
+ *
+ * This is a self-contained C header: producers include it and do not link against Ubitrack.
+ * The producer creates a named POSIX shared-memory object holding a single-producer,
+ * single-consumer ring of fixed-size records, and the \c ApplicationShmPushSource component
+ * with the same \c shmName attaches to it and forwards new records into the dataflow.
+ *
+ * The records have the memory layout of the corresponding Simple* datatypes, so both sides
+ * must be built for the same ABI. A record with timestamp 0 is stamped on arrival.
+ *
+ * The header needs \c ftruncate and \c syscall, which strict modes like \c -std=c99 hide.
+ * It defines \c _DEFAULT_SOURCE itself, which only takes effect if it is included before any
+ * system header. Otherwise define \c _DEFAULT_SOURCE (or \c _GNU_SOURCE) on the command line.
+ *
+ * Example:
+ * @code
+ * // first include, or compile with -D_DEFAULT_SOURCE
+ * #include <utFacade/ShmRing.h>
+ *
+ * utshm_ring ring;
+ * utshm_pose pose = { 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0, 0 };
+ * if ( utshm_ring_create( &ring, "/tracker", UTSHM_RECORD_POSE, 1024 ) == 0 )
+ * {
+ *     utshm_ring_push( &ring, &pose );
+ *     utshm_ring_close( &ring, 1 );
+ * }
+ * @endcode
+ */
+
+#ifndef __UBITRACK_FACADE_SHMRING_H_INCLUDED__
+#define __UBITRACK_FACADE_SHMRING_H_INCLUDED__
+
+/* ftruncate and syscall are not declared in strict ISO C modes */
+#if !defined( _DEFAULT_SOURCE ) && !defined( _GNU_SOURCE )
+#	define _DEFAULT_SOURCE
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#	include <linux/futex.h>
+#	include <sys/syscall.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** identifies an initialized ring, written last by the producer */
+#define UTSHM_RING_MAGIC 0x55545352u
+
+/** layout version of the ring header and records */
+#define UTSHM_RING_VERSION 1u
+
+/** record types, each with the layout of the Simple* datatype of the same name */
+#define UTSHM_RECORD_POSE 1u
+#define UTSHM_RECORD_POSITION3D 2u
+#define UTSHM_RECORD_POSITION2D 3u
+#define UTSHM_RECORD_BUTTON 4u
+
+/** same layout as Ubitrack::Facade::SimplePose */
+typedef struct utshm_pose
+{
+	double tx, ty, tz;
+	double rx, ry, rz, rw;
+	unsigned long long timestamp;
+} utshm_pose;
+
+/** same layout as Ubitrack::Facade::SimplePosition3D */
+typedef struct utshm_position3d
+{
+	double x, y, z;
+	unsigned long long timestamp;
+} utshm_position3d;
+
+/** same layout as Ubitrack::Facade::SimplePosition2D */
+typedef struct utshm_position2d
+{
+	double x, y;
+	unsigned long long timestamp;
+} utshm_position2d;
+
+/** same layout as Ubitrack::Facade::SimpleButton */
+typedef struct utshm_button
+{
+	int event;
+	unsigned long long timestamp;
+} utshm_button;
+
+/**
+ * Header at the start of the shared-memory object, followed by \c capacity records.
+ * The fields written by the producer and by the consumer live on separate cache lines.
+ */
+typedef struct utshm_ring_header
+{
+	/* written once by the producer */
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_type;
+	uint32_t record_size;
+	uint64_t capacity;
+	uint8_t pad0[ 40 ];
+
+	/* written by the producer: records published, records dropped because the ring was full, futex word */
+	uint64_t head;
+	uint64_t dropped;
+	uint32_t wakeup;
+	uint8_t pad1[ 44 ];
+
+	/* written by the consumer: records consumed, non-zero while the consumer sleeps on the futex */
+	uint64_t tail;
+	uint32_t waiting;
+	uint8_t pad2[ 52 ];
+} utshm_ring_header;
+
+/** producer handle */
+typedef struct utshm_ring
+{
+	utshm_ring_header* header;
+	unsigned char* records;
+	size_t mapped_size;
+	char name[ 256 ];
+} utshm_ring;
+
+/** returns the record size of a record type, 0 if unknown */
+static inline uint32_t utshm_record_size( uint32_t record_type )
+{
+	switch ( record_type )
+	{
+		case UTSHM_RECORD_POSE: return sizeof( utshm_pose );
+		case UTSHM_RECORD_POSITION3D: return sizeof( utshm_position3d );
+		case UTSHM_RECORD_POSITION2D: return sizeof( utshm_position2d );
+		case UTSHM_RECORD_BUTTON: return sizeof( utshm_button );
+		default: return 0;
+	}
+}
+
+/** returns the size of the shared-memory object for a ring */
+static inline size_t utshm_ring_size( uint32_t record_size, uint64_t capacity )
+{
+	return sizeof( utshm_ring_header ) + (size_t)record_size * (size_t)capacity;
+}
+
+/**
+ * Creates a ring. An existing object of the same name is unlinked first, so a consumer
+ * attached to it notices the restart and attaches to the new ring.
+ * @param ring handle to initialize
+ * @param name name of the shared-memory object, starting with '/'
+ * @param record_type one of the UTSHM_RECORD_* constants
+ * @param capacity number of records, must be a power of two
+ * @return 0 on success, -1 on error (see errno)
+ */
+static inline int utshm_ring_create( utshm_ring* ring, const char* name, uint32_t record_type, uint64_t capacity )
+{
+	uint32_t record_size = utshm_record_size( record_type );
+	size_t size;
+	int fd;
+	void* p;
+
+	if ( record_size == 0 || capacity == 0 || ( capacity & ( capacity - 1 ) ) != 0 || strlen( name ) >= sizeof( ring->name ) )
+		return -1;
+
+	size = utshm_ring_size( record_size, capacity );
+	shm_unlink( name );
+	fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, 0600 );
+	if ( fd < 0 )
+		return -1;
+	if ( ftruncate( fd, (off_t)size ) != 0 )
+	{
+		close( fd );
+		shm_unlink( name );
+		return -1;
+	}
+	p = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( p == MAP_FAILED )
+	{
+		shm_unlink( name );
+		return -1;
+	}
+
+	ring->header = (utshm_ring_header*)p;
+	ring->records = (unsigned char*)p + sizeof( utshm_ring_header );
+	ring->mapped_size = size;
+	strcpy( ring->name, name );
+
+	/* ftruncate zero-fills, so only the constant fields need to be set */
+	ring->header->version = UTSHM_RING_VERSION;
+	ring->header->record_type = record_type;
+	ring->header->record_size = record_size;
+	ring->header->capacity = capacity;
+	__atomic_store_n( &ring->header->magic, UTSHM_RING_MAGIC, __ATOMIC_RELEASE );
+	return 0;
+}
+
+/** wakes the consumer if it sleeps on the futex */
+static inline void utshm_ring_wake( utshm_ring* ring )
+{
+	__atomic_fetch_add( &ring->header->wakeup, 1u, __ATOMIC_SEQ_CST );
+#ifdef __linux__
+	if ( __atomic_load_n( &ring->header->waiting, __ATOMIC_SEQ_CST ) )
+		syscall( SYS_futex, &ring->header->wakeup, FUTEX_WAKE, 1, NULL, NULL, 0 );
+#endif
+}
+
+/**
+ * Appends records to the ring and wakes the consumer once.
+ * @param ring the ring
+ * @param records array of \c count records of the ring's record type
+ * @param count number of records
+ * @return number of records written; the remaining records are counted as dropped
+ */
+static inline size_t utshm_ring_push_n( utshm_ring* ring, const void* records, size_t count )
+{
+	utshm_ring_header* h = ring->header;
+	uint64_t head = h->head;
+	uint64_t tail = __atomic_load_n( &h->tail, __ATOMIC_ACQUIRE );
+	uint64_t free_slots = h->capacity - ( head - tail );
+	size_t n = count < free_slots ? count : (size_t)free_slots;
+	size_t i;
+
+	for ( i = 0; i < n; i++ )
+		memcpy( ring->records + ( ( head + i ) & ( h->capacity - 1 ) ) * h->record_size,
+			(const unsigned char*)records + i * h->record_size, h->record_size );
+
+	if ( n < count )
+		__atomic_store_n( &h->dropped, h->dropped + ( count - n ), __ATOMIC_RELAXED );
+	if ( n )
+	{
+		__atomic_store_n( &h->head, head + n, __ATOMIC_RELEASE );
+		utshm_ring_wake( ring );
+	}
+	return n;
+}
+
+/**
+ * Appends a record to the ring.
+ * @return 0 on success, -1 if the ring is full and the record was dropped
+ */
+static inline int utshm_ring_push( utshm_ring* ring, const void* record )
+{
+	return utshm_ring_push_n( ring, record, 1 ) == 1 ? 0 : -1;
+}
+
+/**
+ * Unmaps the ring.
+ * @param ring the ring
+ * @param unlink non-zero to remove the shared-memory object
+ */
+static inline void utshm_ring_close( utshm_ring* ring, int unlink )
+{
+	munmap( ring->header, ring->mapped_size );
+	if ( unlink )
+		shm_unlink( ring->name );
+	ring->header = NULL;
+	ring->records = NULL;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __UBITRACK_FACADE_SHMRING_H_INCLUDED__
@@ -1,6 +1,8 @@
 #include "SimpleApplicationPrivate.h"
+#include "Trace.h"
 #include <log4cpp/Category.hh>
 #include <string.h>
+#include <algorithm>
 
 static log4cpp::Category& logger( log4cpp::Category::getInstance( "Ubitrack.Facade.SimpleApplication" ) );
 
@@ -8,14 +10,14 @@ namespace Ubitrack { namespace Facade {
 	
 bool SimpleApplicationPullSinkMatrix3x3Private::getMatrix3x3( SimpleMatrix3x3 & matrix, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkMatrix3x3 > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkMatrix3x3Private::getMatrix3x3 for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::Matrix3x3 p = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkMatrix3x3Private::getMatrix3x3: " << p );
+		UTFACADE_TRACE( PullSink, "Matrix3x3::getMatrix3x3", pSink->getName().c_str(), timestamp );
 		// Convert measurement
 		matrix.values[0] = (*p)(0,0);
 		matrix.values[1] = (*p)(0,1);
@@ -41,14 +43,14 @@ bool SimpleApplicationPullSinkMatrix3x3Private::getMatrix3x3( SimpleMatrix3x3 &
 
 bool SimpleApplicationPullSinkMatrix4x4Private::getMatrix4x4( SimpleMatrix4x4 & matrix, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkMatrix4x4 > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkMatrix4x4Private::getMatrix4x4 for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::Matrix4x4 p = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkMatrix4x4Private::getMatrix4x4: " << p );
+		UTFACADE_TRACE( PullSink, "Matrix4x4::getMatrix4x4", pSink->getName().c_str(), timestamp );
 		// Convert measurement
 		memcpy(matrix.values, p->content(), 16*sizeof(double));		
 		matrix.timestamp = p.time();
@@ -65,19 +67,21 @@ bool SimpleApplicationPullSinkMatrix4x4Private::getMatrix4x4( SimpleMatrix4x4 &
 
 bool SimpleApplicationPullSinkPosition3DPrivate::getPosition3D(  SimplePosition3D & pos, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPosition > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkPosition3DPrivate::getPosition3D for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::Position p = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkPosition3DPrivate::getPosition3D: " << p );
+		UTFACADE_TRACE( PullSink, "Position3D::getPosition3D", pSink->getName().c_str(), timestamp );
 		// Convert measurement
 		pos.x = (*p)[0];
 		pos.y = (*p)[1];
 		pos.z = (*p)[2];
 		pos.timestamp = p.time();
+
+		m_extrapolation.apply( pSink, pos, timestamp );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -91,14 +95,14 @@ bool SimpleApplicationPullSinkPosition3DPrivate::getPosition3D(  SimplePosition3
 
 bool SimpleApplicationPullSinkErrorPosition3DPrivate::getErrorPosition3D( SimpleErrorPosition3D & pos, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkErrorPosition > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkErrorPosition3DPrivate::getErrorPosition3D for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::ErrorPosition p = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkErrorPosition3DPrivate::getErrorPosition3D: " << p );
+		UTFACADE_TRACE( PullSink, "ErrorPosition3D::getErrorPosition3D", pSink->getName().c_str(), timestamp );
 		// Convert measurement		
 	
 		Math::Vector< double, 3 >  v3 = p->value;
@@ -121,88 +125,122 @@ bool SimpleApplicationPullSinkErrorPosition3DPrivate::getErrorPosition3D( Simple
 
 bool SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D(  SimplePositionList3D & pos, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPositionList > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::PositionList p = pSink->get(timestamp);
-		//LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D: " << p );
-		// Convert measurement
-		const std::size_t count ( p->size() );
-		
+		UTFACADE_TRACE( PullSink, "PositionList3D::getPositionList3D", pSink->getName().c_str(), timestamp );
+		// Convert measurement, overwriting the values of the previous call in place
+		convert( p, pos );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D(): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+int SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D( double* pPositions, unsigned int nCapacity, unsigned long long int timestamp )
+{
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPositionList > pSink( m_sink.get() );
+	if ( !pSink || ( nCapacity && !pPositions ) )
+		return -1;
+	
+	try {
+		// Retrieve measurement for current timestamp
+		Ubitrack::Measurement::PositionList p = pSink->get(timestamp);
+		UTFACADE_TRACE( PullSink, "PositionList3D::getPositionList3D", pSink->getName().c_str(), timestamp );
+		// Copy as much as fits, the caller learns the required size from the return value
+		const std::vector< Math::Vector< double, 3 > >& values( *p );
+		const std::size_t count( std::min< std::size_t >( values.size(), nCapacity ) );
 		for( std::size_t i( 0 ); i<count; i++ )
 		{
-			SimplePosition3DValue value;
-			Math::Vector< double, 3 >  v3 = (*p)[i];
-			value.x = v3[0];
-			value.y = v3[1];
-			value.z = v3[2];
-			pos.values.push_back(value);
+			pPositions[ 3 * i ] = values[ i ][ 0 ];
+			pPositions[ 3 * i + 1 ] = values[ i ][ 1 ];
+			pPositions[ 3 * i + 2 ] = values[ i ][ 2 ];
 		}
-		
-		pos.timestamp = p.time();
+		return static_cast< int >( values.size() );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
 		LOG4CPP_ERROR( logger, "Caught exception in SimpleApplicationPullSinkPositionList3DPrivate::getPositionList3D(): " << e );
 		setError( e.what() );
+		return -1;
+	}
+}
+
+bool SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp )
+{
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkErrorPositionList > pSink( m_sink.get() );
+	if ( !pSink )
+		return false;
+	
+	try {
+		// Retrieve measurement for current timestamp
+		Ubitrack::Measurement::ErrorPositionList p = pSink->get(timestamp);
+		UTFACADE_TRACE( PullSink, "ErrorPositionList3D::getErrorPositionList3D", pSink->getName().c_str(), timestamp );
+		// Convert measurement, overwriting the values of the previous call in place
+		convert( p, pos );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D(): " << e );
+		setError( e.what() );
 		return false;
 	}
 
 	return true;
 }
 
-bool SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp )
+int SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D( double* pPositions, double* pCovariances,
+	unsigned int nCapacity, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
-		return false;
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkErrorPositionList > pSink( m_sink.get() );
+	if ( !pSink || ( nCapacity && !pPositions ) )
+		return -1;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::ErrorPositionList p = pSink->get(timestamp);
-		//LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D: " << p );
-		// Convert measurement
-		const std::size_t count ( p->size() );
-		
+		UTFACADE_TRACE( PullSink, "ErrorPositionList3D::getErrorPositionList3D", pSink->getName().c_str(), timestamp );
+		// Copy as much as fits, the caller learns the required size from the return value
+		const std::vector< Math::ErrorVector< double, 3 > >& values( *p );
+		const std::size_t count( std::min< std::size_t >( values.size(), nCapacity ) );
 		for( std::size_t i( 0 ); i<count; i++ )
 		{
-			SimpleErrorPosition3DValue value;
-			Math::Vector< double, 3 >  v3 = (*p)[i].value;
-			value.x = v3[0];
-			value.y = v3[1];
-			value.z = v3[2];
-			
-			memcpy(value.covariance, (*p)[i].covariance.content(), sizeof(double)*9)		;
-			
-			pos.values.push_back(value);
+			pPositions[ 3 * i ] = values[ i ].value[ 0 ];
+			pPositions[ 3 * i + 1 ] = values[ i ].value[ 1 ];
+			pPositions[ 3 * i + 2 ] = values[ i ].value[ 2 ];
+			if ( pCovariances )
+				memcpy( pCovariances + 9 * i, values[ i ].covariance.content(), sizeof( double ) * 9 );
 		}
-			
-		pos.timestamp = p.time();
+		return static_cast< int >( values.size() );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
 		LOG4CPP_ERROR( logger, "Caught exception in SimpleApplicationPullSinkErrorPositionList3DPrivate::getErrorPositionList3D(): " << e );
 		setError( e.what() );
-		return false;
+		return -1;
 	}
-
-	return true;
 }
 
 /** retrieves a pose for the given timestamp */
 bool SimpleApplicationPullSinkErrorPosePrivate::getPose( SimpleErrorPose & p, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkErrorPose > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkPosePrivate::getPose() for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::ErrorPose measurement = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkPosePrivate::getPose(): " << measurement );
+		UTFACADE_TRACE( PullSink, "ErrorPose::getPose", pSink->getName().c_str(), timestamp );
 		// Convert measurement
 				
 			
@@ -2,218 +2,684 @@
 #define __UBITRACK_FACADE_SIMPLEAPPLICATION_PRIVATE_H_INCLUDED__
 
 
+#include <string>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
 #include "../utComponents/ApplicationPullSink.h"
+#include "../utComponents/ApplicationBufferedPullSink.h"
+#include "AdvancedFacade.h"
+#include "Extrapolation.h"
+#include "PullPrefetcher.h"
 #include "SimpleDatatypes.h"
+#include "SimpleConverters.h"
+#include "Trace.h"
 
 namespace Ubitrack { namespace Facade {
 
+/** facade state shared by the pull sink proxies */
+struct PullSinkContext
+{
+	PullSinkContext( AdvancedFacade& facade_, const boost::atomic< unsigned >& generation_, PullPrefetcher& prefetcher_ )
+		: facade( facade_ )
+		, generation( generation_ )
+		, prefetcher( prefetcher_ )
+	{}
+
+	/** the facade the components are looked up in */
+	AdvancedFacade& facade;
+
+	/** incremented whenever the dataflow is loaded or cleared */
+	const boost::atomic< unsigned >& generation;
+
+	/** runs the requestPose calls */
+	PullPrefetcher& prefetcher;
+};
+
+/**
+ * Reference of an interned pull sink proxy to its dataflow component.
+ * The facade increments a generation counter whenever a dataflow is loaded or cleared.
+ * get() compares the counter with the generation of the last lookup and looks up the
+ * component by name again if it has changed, so proxies stay valid across reloads.
+ *
+ * Pulls only compare the generation and copy the published component pointer with
+ * boost::atomic_load, the mutex is only taken to rebind. The copy keeps the component
+ * alive until the pull returns, even if another thread reloads the dataflow meanwhile.
+ * The facade rebinds all proxies after a reload, so they do not keep a cleared dataflow alive.
+ */
+template< class ComponentType >
+class PullSinkBinding
+{
+public:
+	PullSinkBinding( const PullSinkContext& context, const std::string& sName )
+		: m_facade( context.facade )
+		, m_generation( context.generation )
+		, m_sName( sName )
+		, m_nBound( context.generation.load( boost::memory_order_acquire ) - 1 )
+	{}
+
+	/** returns the component or an empty pointer if the current dataflow has no such component */
+	boost::shared_ptr< ComponentType > get()
+	{
+		if ( m_generation.load( boost::memory_order_acquire ) != m_nBound.load( boost::memory_order_acquire ) )
+			rebind();
+		return boost::atomic_load( &m_pComponent );
+	}
+
+	/** true if the current dataflow has the component */
+	bool bound()
+	{ return get().get() != NULL; }
+
+	/** name of the component */
+	const std::string& name() const
+	{ return m_sName; }
+
+protected:
+	/** looks up the component of the current generation unless another thread already did */
+	void rebind()
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		const unsigned nGeneration = m_generation.load( boost::memory_order_acquire );
+		if ( nGeneration == m_nBound.load( boost::memory_order_relaxed ) )
+			return;
+
+		boost::shared_ptr< ComponentType > pComponent;
+		try
+		{
+			pComponent = m_facade.componentByName< ComponentType >( m_sName );
+		}
+		catch ( const Ubitrack::Util::Exception& )
+		{
+		}
+		boost::atomic_store( &m_pComponent, pComponent );
+		m_nBound.store( nGeneration, boost::memory_order_release );
+	}
+
+	AdvancedFacade& m_facade;
+	const boost::atomic< unsigned >& m_generation;
+	const std::string m_sName;
+
+	/** generation of the last lookup, published after \c m_pComponent */
+	boost::atomic< unsigned > m_nBound;
+
+	/** the component of the last lookup, only accessed with boost::atomic_load and atomic_store */
+	boost::shared_ptr< ComponentType > m_pComponent;
+
+	/** serializes rebind */
+	boost::mutex m_mutex;
+};
+
+/**
+ * Last error of a pull sink proxy.
+ * The proxies are interned and shared by all threads that pull from the sink, so the
+ * error is kept per thread: getLastError reports the last failure of the calling thread
+ * and the text stays valid until that thread uses the proxy again.
+ * Failures of tryGet only set a flag, the message is fetched from the sink on demand.
+ */
+class PullSinkError
+{
+public:
+	/** sets the message of the calling thread */
+	void set( const char* sMsg ) throw()
+	{
+		try
+		{
+			State& state( current() );
+			state.sError = sMsg;
+			state.bSet = true;
+			state.bSinkError = false;
+		}
+		catch ( ... )
+		{
+		}
+	}
+
+	/** marks that the message of the last failure of the calling thread is kept by the sink */
+	void setSinkError() throw()
+	{
+		try
+		{
+			current().bSinkError = true;
+		}
+		catch ( ... )
+		{
+		}
+	}
+
+	/** implements getLastError, returns 0 if the calling thread had no failure */
+	template< class EventType >
+	const char* get( const boost::shared_ptr< Components::ApplicationPullSink< EventType > >& pSink )
+	{
+		State* pState = m_state.get();
+		if ( !pState )
+			return 0;
+
+		if ( pState->bSinkError && pSink )
+		{
+			pState->sError = pSink->lastError();
+			pState->bSet = true;
+			pState->bSinkError = false;
+		}
+		return pState->bSet ? pState->sError.c_str() : 0;
+	}
+
+protected:
+	struct State
+	{
+		State()
+			: bSet( false )
+			, bSinkError( false )
+		{}
+
+		std::string sError;
+		bool bSet;
+		bool bSinkError;
+	};
+
+	State& current()
+	{
+		if ( !m_state.get() )
+			m_state.reset( new State );
+		return *m_state;
+	}
+
+	boost::thread_specific_ptr< State > m_state;
+};
+
+/**
+ * Implements the tryGet* methods of the pull sink proxies.
+ * On failure of the sink only the flag in \p error is set, the message is copied from
+ * the sink when getLastError is called. \p sName is reported if the sink is not bound.
+ */
+template< class EventType, class SimpleType >
+SimplePullStatus tryPullSink( const boost::shared_ptr< Components::ApplicationPullSink< EventType > >& pSink, const std::string& sName,
+	SimpleType& value, unsigned long long int timestamp, PullSinkError& error )
+{
+	if ( !pSink )
+	{
+		error.set( ( "No pull sink with name " + sName + " in the current dataflow" ).c_str() );
+		return PULL_ERROR;
+	}
+
+	EventType measurement;
+	SimplePullStatus status( pSink->tryGet( timestamp, measurement ) );
+	UTFACADE_TRACE1( PullSink, "tryGet", pSink->getName().c_str(), timestamp, status );
+	if ( status == PULL_OK || status == PULL_STALE )
+		convert( measurement, value );
+	else
+		error.setSinkError();
+	return status;
+}
+
+/**
+ * Implements the get*Range methods of the pull sink proxies.
+ * Pulls the timestamps t0, t0 + stepNs, ... up to t1 and converts the delivered
+ * measurements into \p pValues. Missing samples are skipped.
+ * @return number of values written or -1 if the arguments are invalid
+ */
+template< class EventType, class SimpleType >
+int pullSinkRange( const boost::shared_ptr< Components::ApplicationPullSink< EventType > >& pSink, unsigned long long int t0, unsigned long long int t1,
+	unsigned long long int stepNs, SimpleType* pValues, unsigned int nMax )
+{
+	if ( !pSink || stepNs == 0 || t1 < t0 || ( nMax && !pValues ) )
+		return -1;
+
+	UTFACADE_TRACE1( PullSink, "getRange", pSink->getName().c_str(), t0, static_cast< double >( t1 - t0 ) );
+
+	EventType measurement;
+	unsigned int n = 0;
+	for ( unsigned long long int t = t0; n < nMax; t += stepNs )
+	{
+		SimplePullStatus status( pSink->tryGet( t, measurement ) );
+		if ( status == PULL_OK || status == PULL_STALE )
+			convert( measurement, pValues[ n++ ] );
+
+		// written this way to avoid an overflow of t
+		if ( t1 - t < stepNs )
+			break;
+	}
+	return static_cast< int >( n );
+}
+
+/**
+ * Implements setExtrapolation of the pose and position pull sink proxies.
+ * If the sink answers a request with a measurement older than the requested timestamp,
+ * as ApplicationBufferedPullSink does after its newest measurement, the measurement is
+ * predicted forward with a constant velocity model. Other pull sinks always answer with
+ * the requested timestamp, so the proxies only enable the extrapolation on buffered sinks.
+ *
+ * The velocity is fitted to the last \c s_nSamples distinct measurements the proxy
+ * delivered within the window before the current one. The proxy keeps them itself, so
+ * the prediction does not pull from the sink and leaves its cache and statistics alone.
+ */
+template< class EventType, class SimpleType >
+class PullSinkExtrapolation
+{
+public:
+	/** number of older measurements used for the velocity */
+	static const unsigned int s_nSamples = 4;
+
+	PullSinkExtrapolation()
+		: m_nMaxHorizon( 0 )
+		, m_nWindow( 0 )
+		, m_nNext( 0 )
+		, m_nCount( 0 )
+	{}
+
+	/** true if \p pSink can answer with older measurements, which the extrapolation needs */
+	static bool applicable( const boost::shared_ptr< Components::ApplicationPullSink< EventType > >& pSink )
+	{ return dynamic_cast< Components::ApplicationBufferedPullSink< EventType >* >( pSink.get() ) != NULL; }
+
+	/** sets the maximum prediction in ns (0 disables the extrapolation) and the length of the history window */
+	void set( unsigned long long int nMaxHorizon, unsigned long long int nWindow )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_nCount = 0;
+		m_nWindow.store( nWindow, boost::memory_order_relaxed );
+		m_nMaxHorizon.store( nMaxHorizon, boost::memory_order_relaxed );
+	}
+
+	/** adds \p value, which the sink delivered for \p timestamp, to the history and predicts it forward if it is older */
+	void apply( const boost::shared_ptr< Components::ApplicationPullSink< EventType > >& pSink, SimpleType& value, unsigned long long int timestamp )
+	{
+		const unsigned long long int nMaxHorizon( m_nMaxHorizon.load( boost::memory_order_relaxed ) );
+		if ( nMaxHorizon == 0 || !pSink )
+			return;
+
+		SimpleType history[ s_nSamples ];
+		unsigned int nCount = 0;
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			const unsigned long long int nWindow( m_nWindow.load( boost::memory_order_relaxed ) );
+			for ( unsigned int i = 0; i < m_nCount; i++ )
+				if ( m_history[ i ].timestamp < value.timestamp && value.timestamp - m_history[ i ].timestamp <= nWindow )
+					history[ nCount++ ] = m_history[ i ];
+			record( value );
+		}
+		if ( value.timestamp >= timestamp || nCount == 0 )
+			return;
+
+		const unsigned long long int nHorizon( timestamp - value.timestamp );
+		UTFACADE_TRACE1( PullSink, "extrapolate", pSink->getName().c_str(), timestamp, static_cast< double >( nHorizon ) );
+		extrapolate( history, nCount, value, value.timestamp + ( nHorizon < nMaxHorizon ? nHorizon : nMaxHorizon ), value );
+	}
+
+protected:
+	/** adds \p value to the history if it is newer than all entries, \c m_mutex must be locked */
+	void record( const SimpleType& value )
+	{
+		if ( m_nCount && m_history[ ( m_nNext + s_nSamples - 1 ) % s_nSamples ].timestamp >= value.timestamp )
+			return;
+
+		m_history[ m_nNext ] = value;
+		m_nNext = ( m_nNext + 1 ) % s_nSamples;
+		if ( m_nCount < s_nSamples )
+			m_nCount++;
+	}
+
+	boost::atomic< unsigned long long int > m_nMaxHorizon;
+	boost::atomic< unsigned long long int > m_nWindow;
+
+	/** ring buffer of the newest delivered measurements */
+	SimpleType m_history[ s_nSamples ];
+	unsigned int m_nNext;
+	unsigned int m_nCount;
+	boost::mutex m_mutex;
+};
+
+/**
+ * Implements requestPose and collectPose of the pull sink proxies.
+ * Keeps the results of the last few requested timestamps, which are filled in by
+ * the PullPrefetcher thread.
+ */
+template< class EventType, class SimpleType >
+class PullSinkPrefetch
+	: public PrefetchTarget
+{
+public:
+	PullSinkPrefetch( PullSinkBinding< Components::ApplicationPullSink< EventType > >& sink, PullPrefetcher& prefetcher )
+		: m_sink( sink )
+		, m_prefetcher( prefetcher )
+		, m_nNext( 0 )
+	{
+		for ( std::size_t i = 0; i < s_nSlots; i++ )
+			m_slots[ i ].bUsed = false;
+	}
+
+	/** schedules a pull for \p t unless it is already requested */
+	void request( unsigned long long int t )
+	{
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			if ( findSlot( t ) )
+				return;
+
+			// overwrite the oldest request
+			Slot& slot( m_slots[ m_nNext ] );
+			m_nNext = ( m_nNext + 1 ) % s_nSlots;
+			slot.bUsed = true;
+			slot.timestamp = t;
+			slot.status = PULL_PENDING;
+		}
+		m_prefetcher.request( this, t );
+	}
+
+	/**
+	 * Returns the result for \p t without blocking.
+	 * @return PULL_PENDING if the pull has not finished yet, PULL_ERROR if \p t was not requested
+	 */
+	SimplePullStatus collect( unsigned long long int t, SimpleType& value )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		Slot* pSlot = findSlot( t );
+		if ( !pSlot )
+			return PULL_ERROR;
+
+		if ( pSlot->status == PULL_OK || pSlot->status == PULL_STALE )
+			value = pSlot->value;
+		return pSlot->status;
+	}
+
+	/** @copydoc PrefetchTarget::prefetch */
+	void prefetch( unsigned long long t )
+	{
+		SimpleType value;
+		SimplePullStatus status( PULL_ERROR );
+		if ( boost::shared_ptr< Components::ApplicationPullSink< EventType > > pSink = m_sink.get() )
+		{
+			EventType measurement;
+			status = pSink->tryGet( t, measurement );
+			if ( status == PULL_OK || status == PULL_STALE )
+				convert( measurement, value );
+		}
+
+		boost::mutex::scoped_lock lock( m_mutex );
+		// the slot may have been reused for a newer request in the meantime
+		Slot* pSlot = findSlot( t );
+		if ( pSlot && pSlot->status == PULL_PENDING )
+		{
+			pSlot->value = value;
+			pSlot->status = status;
+		}
+	}
+
+protected:
+	/** number of timestamps that can be requested before the oldest result is dropped */
+	static const std::size_t s_nSlots = 4;
+
+	struct Slot
+	{
+		bool bUsed;
+		unsigned long long int timestamp;
+		SimplePullStatus status;
+		SimpleType value;
+	};
+
+	/** \c m_mutex must be locked */
+	Slot* findSlot( unsigned long long int t )
+	{
+		for ( std::size_t i = 0; i < s_nSlots; i++ )
+			if ( m_slots[ i ].bUsed && m_slots[ i ].timestamp == t )
+				return &m_slots[ i ];
+		return 0;
+	}
+
+	PullSinkBinding< Components::ApplicationPullSink< EventType > >& m_sink;
+	PullPrefetcher& m_prefetcher;
+	Slot m_slots[ s_nSlots ];
+	std::size_t m_nNext;
+	boost::mutex m_mutex;
+};
+
 
 class SimpleApplicationPullSinkMatrix3x3Private 
 	: public SimpleApplicationPullSinkMatrix3x3 {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkMatrix3x3 * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkMatrix3x3 > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 	
 	
 
 
 public:
-	SimpleApplicationPullSinkMatrix3x3Private( Ubitrack::Components::ApplicationPullSinkMatrix3x3 * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkMatrix3x3Private()
-	{
-		if ( m_sError )
-			free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkMatrix3x3 ComponentType;
+
+	SimpleApplicationPullSinkMatrix3x3Private( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
 	
 	virtual bool getMatrix3x3( SimpleMatrix3x3 & matrix, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetMatrix3x3( SimpleMatrix3x3 & matrix, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), matrix, timestamp, m_error ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 class SimpleApplicationPullSinkMatrix4x4Private 
 	: public SimpleApplicationPullSinkMatrix4x4 {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkMatrix4x4 * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkMatrix4x4 > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 	
 	
 
 
 public:
-	SimpleApplicationPullSinkMatrix4x4Private( Ubitrack::Components::ApplicationPullSinkMatrix4x4 * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkMatrix4x4Private()
-	{
-		if ( m_sError )
-			free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkMatrix4x4 ComponentType;
+
+	SimpleApplicationPullSinkMatrix4x4Private( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
 	
 	virtual bool getMatrix4x4( SimpleMatrix4x4 & matrix, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetMatrix4x4( SimpleMatrix4x4 & matrix, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), matrix, timestamp, m_error ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 class SimpleApplicationPullSinkPosition3DPrivate 
 	: public SimpleApplicationPullSinkPosition3D {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkPosition * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkPosition > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
+
+	/** prediction of positions after the newest measurement */
+	PullSinkExtrapolation< Measurement::Position, SimplePosition3D > m_extrapolation;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 
 
 public:
-	SimpleApplicationPullSinkPosition3DPrivate( Ubitrack::Components::ApplicationPullSinkPosition * pSink ): m_sError( 0 )
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkPosition ComponentType;
+
+	SimpleApplicationPullSinkPosition3DPrivate( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
+	
+	virtual bool getPosition3D( SimplePosition3D & pos, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetPosition3D( SimplePosition3D & pos, unsigned long long int timestamp )
 	{
-		this->pSink = pSink;
+		boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPosition > pSink( m_sink.get() );
+		SimplePullStatus status( tryPullSink( pSink, m_sink.name(), pos, timestamp, m_error ) );
+		if ( status == PULL_OK )
+			m_extrapolation.apply( pSink, pos, timestamp );
+		return status;
 	}
-	
-	~SimpleApplicationPullSinkPosition3DPrivate()
+
+	virtual bool setExtrapolation( unsigned long long int maxHorizonNs, unsigned long long int windowNs = 40000000ULL )
 	{
-		if ( m_sError )
-			free( m_sError );
+		if ( maxHorizonNs && !m_extrapolation.applicable( m_sink.get() ) )
+		{
+			setError( ( "Extrapolation needs an ApplicationBufferedPullSink, " + m_sink.name() + " is none" ).c_str() );
+			return false;
+		}
+		m_extrapolation.set( maxHorizonNs, windowNs );
+		return true;
 	}
-	
-	virtual bool getPosition3D( SimplePosition3D & pos, unsigned long long int timestamp );
+
+	virtual int getPosition3DRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimplePosition3D* pPositions, unsigned int nMax )
+	{ return pullSinkRange( m_sink.get(), t0, t1, stepNs, pPositions, nMax ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 class SimpleApplicationPullSinkErrorPosition3DPrivate 
 	: public SimpleApplicationPullSinkErrorPosition3D {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkErrorPosition * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkErrorPosition > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 
 
 public:
-	SimpleApplicationPullSinkErrorPosition3DPrivate( Ubitrack::Components::ApplicationPullSinkErrorPosition * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkErrorPosition3DPrivate()
-	{
-		if ( m_sError )
-			free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkErrorPosition ComponentType;
+
+	SimpleApplicationPullSinkErrorPosition3DPrivate( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
 	
 	virtual bool getErrorPosition3D( SimpleErrorPosition3D & pos, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetErrorPosition3D( SimpleErrorPosition3D & pos, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), pos, timestamp, m_error ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 class SimpleApplicationPullSinkPositionList3DPrivate 
 	: public SimpleApplicationPullSinkPositionList3D {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkPositionList * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkPositionList > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 
 
 public:
-	SimpleApplicationPullSinkPositionList3DPrivate( Ubitrack::Components::ApplicationPullSinkPositionList * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkPositionList3DPrivate()
-	{
-		if ( m_sError )
-			free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkPositionList ComponentType;
+
+	SimpleApplicationPullSinkPositionList3DPrivate( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
 	
 	virtual bool getPositionList3D( SimplePositionList3D & pos, unsigned long long int timestamp );
+
+	virtual int getPositionList3D( double* pPositions, unsigned int nCapacity, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetPositionList3D( SimplePositionList3D & pos, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), pos, timestamp, m_error ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 class SimpleApplicationPullSinkErrorPositionList3DPrivate 
 	: public SimpleApplicationPullSinkErrorPositionList3D {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkErrorPositionList * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkErrorPositionList > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 
 
 public:
-	SimpleApplicationPullSinkErrorPositionList3DPrivate( Ubitrack::Components::ApplicationPullSinkErrorPositionList * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkErrorPositionList3DPrivate()
-	{
-		if ( m_sError )
-			free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkErrorPositionList ComponentType;
+
+	SimpleApplicationPullSinkErrorPositionList3DPrivate( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+	{}
 	
 	virtual bool getErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp );
+
+	virtual int getErrorPositionList3D( double* pPositions, double* pCovariances, unsigned int nCapacity,
+		unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), pos, timestamp, m_error ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 
@@ -221,35 +687,51 @@ class SimpleApplicationPullSinkErrorPosePrivate
 	: public SimpleApplicationPullSinkErrorPose {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkErrorPose * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkErrorPose > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
+
+	/** results of requestPose */
+	PullSinkPrefetch< Measurement::ErrorPose, SimpleErrorPose > m_prefetch;
 
 	/** sets the internal error string */
 	void setError( const char* sMsg ) throw()
-	{
-		if ( m_sError )
-			free( m_sError );
-		m_sError = strdup( sMsg );
-	}
+	{ m_error.set( sMsg ); }
 	
 
 
 public:
-	SimpleApplicationPullSinkErrorPosePrivate( Ubitrack::Components::ApplicationPullSinkErrorPose * pSink ): m_sError( 0 )
-	{
-		this->pSink = pSink;
-	}
-	
-	~SimpleApplicationPullSinkErrorPosePrivate()
-	{
-		if ( m_sError )
-		free( m_sError );
-	}
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkErrorPose ComponentType;
+
+	SimpleApplicationPullSinkErrorPosePrivate( const PullSinkContext& context, const std::string& sName )
+		: m_sink( context, sName )
+		, m_prefetch( m_sink, context.prefetcher )
+	{}
 	
 	virtual bool getPose( SimpleErrorPose & pose, unsigned long long int timestamp );
+
+	virtual SimplePullStatus tryGetPose( SimpleErrorPose & pose, unsigned long long int timestamp )
+	{ return tryPullSink( m_sink.get(), m_sink.name(), pose, timestamp, m_error ); }
+
+	virtual int getPoseRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimpleErrorPose* pPoses, unsigned int nMax )
+	{ return pullSinkRange( m_sink.get(), t0, t1, stepNs, pPoses, nMax ); }
+
+	virtual void requestPose( unsigned long long int timestamp )
+	{ m_prefetch.request( timestamp ); }
+
+	virtual SimplePullStatus collectPose( unsigned long long int timestamp, SimpleErrorPose & pose )
+	{ return m_prefetch.collect( timestamp, pose ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
 };
 
 
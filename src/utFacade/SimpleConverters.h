@@ -0,0 +1,452 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Conversion of measurements to the simple datatypes and dispatch to the simple receivers.
+ *
+ * \c SimpleConverter<EventType> selects at compile time the simple type, the receiver
+ * interfaces and the conversion for a measurement type, so that \c ApplicationPushSink
+ * can call the receivers directly.
+ */
+
+#ifndef __UBITRACK_FACADE_SIMPLECONVERTERS_H_INCLUDED__
+#define __UBITRACK_FACADE_SIMPLECONVERTERS_H_INCLUDED__
+
+#include <string.h>
+#include <vector>
+#include <utMeasurement/Measurement.h>
+#include <utFacade/SimpleDatatypes.h>
+
+namespace Ubitrack { namespace Facade {
+
+// converts Measurement::Pose to SimplePose
+inline void convert( const Measurement::Pose& measurement, SimplePose& p )
+{
+	p.tx = measurement->translation()( 0 );
+	p.ty = measurement->translation()( 1 );
+	p.tz = measurement->translation()( 2 );
+	p.rx = measurement->rotation().x();
+	p.ry = measurement->rotation().y();
+	p.rz = measurement->rotation().z();
+	p.rw = measurement->rotation().w();
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::ErrorPose to SimplePose, dropping the covariance
+inline void convert( const Measurement::ErrorPose& measurement, SimplePose& p )
+{
+	p.tx = measurement->translation()( 0 );
+	p.ty = measurement->translation()( 1 );
+	p.tz = measurement->translation()( 2 );
+	p.rx = measurement->rotation().x();
+	p.ry = measurement->rotation().y();
+	p.rz = measurement->rotation().z();
+	p.rw = measurement->rotation().w();
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::ErrorPose to SimpleErrorPose
+inline void convert( const Measurement::ErrorPose& measurement, SimpleErrorPose& p )
+{
+	p.tx = measurement->translation()( 0 );
+	p.ty = measurement->translation()( 1 );
+	p.tz = measurement->translation()( 2 );
+	p.rx = measurement->rotation().x();
+	p.ry = measurement->rotation().y();
+	p.rz = measurement->rotation().z();
+	p.rw = measurement->rotation().w();
+	
+	p.co11 = measurement->covariance()(0, 0); p.co12 = measurement->covariance()(0, 1); p.co13 = measurement->covariance()(0, 2);
+	p.co14 = measurement->covariance()(0, 3); p.co15 = measurement->covariance()(0, 4); p.co16 = measurement->covariance()(0, 5);
+
+	p.co21 = measurement->covariance()(1, 0); p.co22 = measurement->covariance()(1, 1); p.co23 = measurement->covariance()(1, 2);
+	p.co24 = measurement->covariance()(1, 3); p.co25 = measurement->covariance()(1, 4); p.co26 = measurement->covariance()(1, 5);
+
+	p.co31 = measurement->covariance()(2, 0); p.co32 = measurement->covariance()(2, 1); p.co33 = measurement->covariance()(2, 2);
+	p.co34 = measurement->covariance()(2, 3); p.co35 = measurement->covariance()(2, 4); p.co36 = measurement->covariance()(2, 5);
+
+	p.co41 = measurement->covariance()(3, 0); p.co42 = measurement->covariance()(3, 1); p.co43 = measurement->covariance()(3, 2);
+	p.co44 = measurement->covariance()(3, 3); p.co45 = measurement->covariance()(3, 4); p.co46 = measurement->covariance()(3, 5);
+
+	p.co51 = measurement->covariance()(4, 0); p.co52 = measurement->covariance()(4, 1); p.co53 = measurement->covariance()(4, 2);
+	p.co54 = measurement->covariance()(4, 3); p.co55 = measurement->covariance()(4, 4); p.co56 = measurement->covariance()(4, 5);
+
+	p.co61 = measurement->covariance()(5, 0); p.co62 = measurement->covariance()(5, 1); p.co63 = measurement->covariance()(5, 2);
+	p.co64 = measurement->covariance()(5, 3); p.co65 = measurement->covariance()(5, 4); p.co66 = measurement->covariance()(5, 5);	
+	
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::Matrix3x4 to SimpleMatrix3x4
+inline void convert( const Measurement::Matrix3x4& measurement, SimpleMatrix3x4& p )
+{
+	p.e11 = (*measurement)(0,0);
+	p.e21 = (*measurement)(1,0);
+	p.e31 = (*measurement)(2,0);
+	p.e12 = (*measurement)(0,1);
+	p.e22 = (*measurement)(1,1);
+	p.e32 = (*measurement)(2,1);
+	p.e13 = (*measurement)(0,2);
+	p.e23 = (*measurement)(1,2);
+	p.e33 = (*measurement)(2,2);
+	p.e14 = (*measurement)(0,3);
+	p.e24 = (*measurement)(1,3);
+	p.e34 = (*measurement)(2,3);
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::Matrix3x3 to SimpleMatrix3x3 (row major)
+inline void convert( const Measurement::Matrix3x3& measurement, SimpleMatrix3x3& p )
+{
+	for ( int r = 0; r < 3; r++ )
+		for ( int c = 0; c < 3; c++ )
+			p.values[ r * 3 + c ] = (*measurement)( r, c );
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::Matrix4x4 to SimpleMatrix4x4
+inline void convert( const Measurement::Matrix4x4& measurement, SimpleMatrix4x4& p )
+{
+	memcpy(p.values,measurement->content() , 16*sizeof(double));		
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::Distance to SimpleDistance
+inline void convert( const Measurement::Distance& measurement, SimpleDistance& d )
+{
+	d.d = *measurement;
+	d.timestamp = measurement.time();
+}
+
+// converts Measurement::Position2D to SimplePosition2D
+inline void convert( const Measurement::Position2D& measurement, SimplePosition2D& p )
+{
+	p.x = (*measurement)(0);
+	p.y = (*measurement)(1);
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::Position to SimplePosition3D
+inline void convert( const Measurement::Position& measurement, SimplePosition3D& value )
+{
+	value.x = (*measurement)[0];
+	value.y = (*measurement)[1];
+	value.z = (*measurement)[2];
+	value.timestamp = measurement.time();
+}
+
+// converts Measurement::ErrorPosition to SimpleErrorPosition3D
+inline void convert( const Measurement::ErrorPosition& measurement, SimpleErrorPosition3D& value )
+{
+	const Math::Vector< double, 3 >& v3 = measurement->value;
+	value.x = v3[0];
+	value.y = v3[1];
+	value.z = v3[2];
+	memcpy(value.covariance, measurement->covariance.content(), sizeof(double)*9);
+	value.timestamp = measurement.time();
+}
+
+// converts Measurement::PositionList2 to SimplePosition2DList, reusing the storage of the list
+inline void convert( const Measurement::PositionList2& measurement, SimplePosition2DList& p )
+{
+	const std::vector< Math::Vector< double, 2 > >& values( *measurement );
+	const std::size_t count( values.size() );
+	p.values.resize( count );
+	for( std::size_t i( 0 ); i<count; i++ )
+	{
+		p.values[ i ].x = values[ i ][ 0 ];
+		p.values[ i ].y = values[ i ][ 1 ];
+	}
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::PositionList to SimplePositionList3D, reusing the storage of the list
+inline void convert( const Measurement::PositionList& measurement, SimplePositionList3D& p )
+{
+	const std::vector< Math::Vector< double, 3 > >& values( *measurement );
+	const std::size_t count( values.size() );
+	p.values.resize( count );
+	for( std::size_t i( 0 ); i<count; i++ )
+	{
+		p.values[ i ].x = values[ i ][ 0 ];
+		p.values[ i ].y = values[ i ][ 1 ];
+		p.values[ i ].z = values[ i ][ 2 ];
+	}
+	p.timestamp = measurement.time();
+}
+
+// converts Measurement::ErrorPositionList to SimpleErrorPositionList3D, reusing the storage of the list
+inline void convert( const Measurement::ErrorPositionList& measurement, SimpleErrorPositionList3D& p )
+{
+	const std::vector< Math::ErrorVector< double, 3 > >& values( *measurement );
+	const std::size_t count( values.size() );
+	p.values.resize( count );
+	for( std::size_t i( 0 ); i<count; i++ )
+	{
+		p.values[ i ].x = values[ i ].value[ 0 ];
+		p.values[ i ].y = values[ i ].value[ 1 ];
+		p.values[ i ].z = values[ i ].value[ 2 ];
+		memcpy( p.values[ i ].covariance, values[ i ].covariance.content(), sizeof( double ) * 9 );
+	}
+	p.timestamp = measurement.time();
+}
+
+
+/** placeholder simple type for measurements without a simple representation */
+struct NoSimpleType
+{};
+
+/** placeholder receiver for measurements without a simple representation, never defined */
+class NoSimpleReceiver;
+
+/** part of the converter traits for types without batch receiver */
+template< class SimpleT >
+struct SimpleConverterNoBatch
+{
+	typedef NoSimpleReceiver BatchReceiverType;
+
+	static void dispatchBatch( BatchReceiverType*, const SimpleT*, std::size_t )
+	{}
+};
+
+/**
+ * Tells whether a simple datatype has a fixed size and can be copied with memcpy,
+ * which is required to publish it in a \c SeqlockSlot. False for the list types.
+ */
+template< class SimpleT >
+struct SimpleTypeIsFixedSize
+{
+	static const bool value = true;
+};
+
+template<> struct SimpleTypeIsFixedSize< NoSimpleType > { static const bool value = false; };
+template<> struct SimpleTypeIsFixedSize< SimplePosition2DList > { static const bool value = false; };
+template<> struct SimpleTypeIsFixedSize< SimplePositionList3D > { static const bool value = false; };
+template<> struct SimpleTypeIsFixedSize< SimpleErrorPositionList3D > { static const bool value = false; };
+
+/**
+ * Converter traits for a measurement type, providing
+ * - \c SimpleType: the simple datatype the measurement is converted to
+ * - \c ReceiverType and \c BatchReceiverType: the receiver interfaces
+ * - \c convert, \c dispatch and \c dispatchBatch
+ *
+ * This primary template is used for measurements without a simple representation.
+ * Its receivers cannot be instantiated, so the dispatch functions are never called.
+ */
+template< class EventType >
+struct SimpleConverter
+	: public SimpleConverterNoBatch< NoSimpleType >
+{
+	typedef NoSimpleType SimpleType;
+	typedef NoSimpleReceiver ReceiverType;
+
+	static void convert( const EventType&, SimpleType& )
+	{}
+
+	static void dispatch( ReceiverType*, const SimpleType& )
+	{}
+};
+
+template<>
+struct SimpleConverter< Measurement::Pose >
+{
+	typedef SimplePose SimpleType;
+	typedef SimplePoseReceiver ReceiverType;
+	typedef SimplePoseBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Pose& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receivePose( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receivePoses( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::ErrorPose >
+{
+	typedef SimpleErrorPose SimpleType;
+	typedef SimpleErrorPoseReceiver ReceiverType;
+	typedef SimpleErrorPoseBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::ErrorPose& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveErrorPose( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receiveErrorPoses( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::Matrix3x4 >
+{
+	typedef SimpleMatrix3x4 SimpleType;
+	typedef SimpleMatrix3x4Receiver ReceiverType;
+	typedef SimpleMatrix3x4BatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Matrix3x4& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveMatrix3x4( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receiveMatrices3x4( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::Matrix4x4 >
+{
+	typedef SimpleMatrix4x4 SimpleType;
+	typedef SimpleMatrix4x4Receiver ReceiverType;
+	typedef SimpleMatrix4x4BatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Matrix4x4& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveMatrix4x4( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receiveMatrices4x4( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::Distance >
+{
+	typedef SimpleDistance SimpleType;
+	typedef SimpleDistanceReceiver ReceiverType;
+	typedef SimpleDistanceBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Distance& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveDistance( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receiveDistances( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::Position2D >
+{
+	typedef SimplePosition2D SimpleType;
+	typedef SimplePosition2DReceiver ReceiverType;
+	typedef SimplePosition2DBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Position2D& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receivePosition2D( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receivePositions2D( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::Position >
+{
+	typedef SimplePosition3D SimpleType;
+	typedef SimplePosition3DReceiver ReceiverType;
+	typedef SimplePosition3DBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::Position& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receivePosition3D( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receivePositions3D( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::ErrorPosition >
+{
+	typedef SimpleErrorPosition3D SimpleType;
+	typedef SimpleErrorPosition3DReceiver ReceiverType;
+	typedef SimpleErrorPosition3DBatchReceiver BatchReceiverType;
+
+	static void convert( const Measurement::ErrorPosition& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveErrorPosition3D( s ); }
+
+	static void dispatchBatch( BatchReceiverType* pReceiver, const SimpleType* s, std::size_t n )
+	{ pReceiver->receiveErrorPositions3D( s, n ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::PositionList2 >
+	: public SimpleConverterNoBatch< SimplePosition2DList >
+{
+	typedef SimplePosition2DList SimpleType;
+	typedef SimplePosition2DListReceiver ReceiverType;
+
+	static void convert( const Measurement::PositionList2& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receivePosition2DList( s ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::PositionList >
+	: public SimpleConverterNoBatch< SimplePositionList3D >
+{
+	typedef SimplePositionList3D SimpleType;
+	typedef SimplePositionList3DReceiver ReceiverType;
+
+	static void convert( const Measurement::PositionList& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receivePositionList3D( s ); }
+};
+
+template<>
+struct SimpleConverter< Measurement::ErrorPositionList >
+	: public SimpleConverterNoBatch< SimpleErrorPositionList3D >
+{
+	typedef SimpleErrorPositionList3D SimpleType;
+	typedef SimpleErrorPositionList3DReceiver ReceiverType;
+
+	static void convert( const Measurement::ErrorPositionList& m, SimpleType& s )
+	{ Facade::convert( m, s ); }
+
+	static void dispatch( ReceiverType* pReceiver, const SimpleType& s )
+	{ pReceiver->receiveErrorPositionList3D( s ); }
+};
+
+} } // namespace Ubitrack::Facade
+
+#endif
@@ -31,6 +31,7 @@
 #ifndef __UBITRACK_FACADE_SIMPLEDATATYPES_H_INCLUDED__
 #define __UBITRACK_FACADE_SIMPLEDATATYPES_H_INCLUDED__
 
+#include <stddef.h>
 #include "SimpleVectorTypes.h"
 
 
@@ -192,6 +193,158 @@ struct SimpleDistance
 };
 
 
+/**
+ * Delivery statistics of an ApplicationPushSink
+ */
+struct SimplePushSinkStats
+{
+	/** number of events the sink received from the dataflow network */
+	unsigned long long received;
+
+	/** number of events passed to the application callback */
+	unsigned long long delivered;
+
+	/** number of events dropped because the hand-off queue was full */
+	unsigned long long overruns;
+
+	/** number of events replaced by a newer event under the latest-value policy */
+	unsigned long long conflated;
+};
+
+
+/**
+ * Decoding and admission statistics of an ApplicationPushSource
+ */
+struct SimplePushSourceStats
+{
+	/** number of string or binary events dropped because they could not be decoded */
+	unsigned long long parseErrors;
+
+	/** number of strings read by the allocation-free text parser */
+	unsigned long long fastParsed;
+
+	/** number of strings read by the boost archive */
+	unsigned long long archiveParsed;
+
+	/** number of events passed on to the dataflow by the admission policy */
+	unsigned long long admitted;
+
+	/** number of held events replaced by a newer event under the coalesce policy */
+	unsigned long long coalesced;
+
+	/** number of events dropped by the rate limit, from a full backlog or when the source stopped */
+	unsigned long long dropped;
+};
+
+
+/**
+ * Result of a pull request for a single sink
+ */
+enum SimplePullStatus
+{
+	/** the measurement was retrieved */
+	PULL_OK = 0,
+
+	/** the sink does not exist, has the wrong type or could not provide a measurement */
+	PULL_ERROR = 1,
+
+	/** the sink has not delivered any measurement since the dataflow was started */
+	PULL_NO_DATA = 2,
+
+	/** a measurement was retrieved, but it is older than the staleAfterMs setting of the sink */
+	PULL_STALE = 3,
+
+	/** the measurement was requested in advance, but the pull has not finished yet */
+	PULL_PENDING = 4
+};
+
+
+/**
+ * Result cache statistics of an ApplicationPullSink
+ */
+struct SimplePullCacheStats
+{
+	/** number of requests answered from the cache */
+	unsigned long long hits;
+
+	/** number of requests passed to the dataflow network while the cache was enabled */
+	unsigned long long misses;
+
+	/** number of cache entries, 0 if the cache is disabled */
+	unsigned int size;
+};
+
+
+/**
+ * Latency statistics of an ApplicationPushSink since the last reset.
+ * All durations are in nanoseconds, percentiles are approximate.
+ */
+struct SimpleLatencyStats
+{
+	/** number of events received */
+	unsigned long long count;
+
+	/** events per second */
+	double rate;
+
+	/** age of events on arrival at the sink, i.e. reception time minus measurement timestamp */
+	unsigned long long ageP50;
+	unsigned long long ageP90;
+	unsigned long long ageP99;
+	unsigned long long ageMax;
+
+	/** time spent in the application callback */
+	unsigned long long callbackP50;
+	unsigned long long callbackP90;
+	unsigned long long callbackP99;
+	unsigned long long callbackMax;
+};
+
+
+/**
+ * Policy of an ApplicationPushSink for events the application has not consumed yet
+ */
+enum SimpleDeliveryPolicy
+{
+	/** deliver every event in order, drop new events if the queue is full */
+	DELIVER_FIFO = 0,
+
+	/** deliver only the newest event, replacing older undelivered ones */
+	DELIVER_LATEST = 1
+};
+
+
+/** version of the binary measurement format written by SimpleBinaryReceiver callbacks */
+const unsigned char SIMPLE_BINARY_VERSION = 1;
+
+/** size in bytes of the header preceding each binary measurement */
+const unsigned int SIMPLE_BINARY_HEADER_SIZE = 16;
+
+/**
+ * Measurement types of the binary format, stored in the second byte of the header.
+ * The layout is described in BinaryCodec.h.
+ */
+enum SimpleBinaryType
+{
+	BINARY_BUTTON = 1,
+	BINARY_DISTANCE = 2,
+	BINARY_POSITION2D = 3,
+	BINARY_POSITION3D = 4,
+	BINARY_ROTATION = 5,
+	BINARY_POSE = 6,
+	BINARY_ERROR_POSITION3D = 7,
+	BINARY_ERROR_POSE = 8,
+	BINARY_MATRIX3X3 = 9,
+	BINARY_MATRIX3X4 = 10,
+	BINARY_MATRIX4X4 = 11,
+	BINARY_POSITION2D_LIST = 12,
+	BINARY_POSITION3D_LIST = 13,
+	BINARY_ERROR_POSITION2D_LIST = 14,
+	BINARY_ERROR_POSITION3D_LIST = 15,
+	BINARY_POSE_LIST = 16
+};
+
+
 /**
  * A simple callback interface to transport SimplePoses
  */
@@ -342,6 +495,103 @@ public:
 };
 
 
+/**
+ * Batch callback interfaces.
+ * Receive all events an ApplicationPushSink collected during its batch window in
+ * one call. The array is only valid during the call.
+ *
+ * The push sources for poses, positions and buttons implement these interfaces as
+ * well, so applications can send several events in one call, see SimpleFacade::getPushSourcePoseBatch.
+ */
+class SimplePoseBatchReceiver
+{
+public:
+	/** receives \p count SimplePose events */
+	virtual void receivePoses( const SimplePose* poses, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimplePoseBatchReceiver()
+	{}
+};
+
+class SimpleErrorPoseBatchReceiver
+{
+public:
+	/** receives \p count SimpleErrorPose events */
+	virtual void receiveErrorPoses( const SimpleErrorPose* poses, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleErrorPoseBatchReceiver()
+	{}
+};
+
+class SimplePosition2DBatchReceiver
+{
+public:
+	/** receives \p count SimplePosition2D events */
+	virtual void receivePositions2D( const SimplePosition2D* positions, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimplePosition2DBatchReceiver()
+	{}
+};
+
+class SimplePosition3DBatchReceiver
+{
+public:
+	/** receives \p count SimplePosition3D events */
+	virtual void receivePositions3D( const SimplePosition3D* positions, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimplePosition3DBatchReceiver()
+	{}
+};
+
+class SimpleErrorPosition3DBatchReceiver
+{
+public:
+	/** receives \p count SimpleErrorPosition3D events */
+	virtual void receiveErrorPositions3D( const SimpleErrorPosition3D* positions, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleErrorPosition3DBatchReceiver()
+	{}
+};
+
+class SimpleMatrix3x4BatchReceiver
+{
+public:
+	/** receives \p count SimpleMatrix3x4 events */
+	virtual void receiveMatrices3x4( const SimpleMatrix3x4* matrices, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleMatrix3x4BatchReceiver()
+	{}
+};
+
+class SimpleMatrix4x4BatchReceiver
+{
+public:
+	/** receives \p count SimpleMatrix4x4 events */
+	virtual void receiveMatrices4x4( const SimpleMatrix4x4* matrices, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleMatrix4x4BatchReceiver()
+	{}
+};
+
+class SimpleDistanceBatchReceiver
+{
+public:
+	/** receives \p count SimpleDistance events */
+	virtual void receiveDistances( const SimpleDistance* distances, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleDistanceBatchReceiver()
+	{}
+};
+
+
 /**
  * A simplified version of the Measurement::Button type without boost.
  */
@@ -369,6 +619,20 @@ public:
 	{}
 };
 
+/**
+ * Batch interface to send several SimpleButton events in one call, see SimplePoseBatchReceiver.
+ */
+class SimpleButtonBatchReceiver
+{
+public:
+	/** receives \p count SimpleButton events */
+	virtual void receiveButtons( const SimpleButton* buttons, size_t count ) throw() = 0;
+
+	/** virtual destructor */
+	virtual ~SimpleButtonBatchReceiver()
+	{}
+};
+
 
 /**
  * A simplified version of the Measurement::ImageMeasurement type without boost.
@@ -420,6 +684,26 @@ public:
 };
 
 
+/**
+ * A simple callback interface to transport measurements in a compact binary format.
+ * Each call carries one measurement, see BinaryCodec.h for the layout.
+ */
+class SimpleBinaryReceiver
+{
+public:
+	/**
+	 * receives a binary measurement
+	 * @param pData the encoded measurement, only valid during the call
+	 * @param nBytes size of the encoded measurement including the header
+	 */
+	virtual void receiveBinary( const void* pData, size_t nBytes ) throw() = 0;
+	
+	/** virtual destructor */
+	virtual ~SimpleBinaryReceiver()
+	{}
+};
+
+
 /**
  * A simple data flow observer
  */
@@ -446,11 +730,11 @@ protected:
 	SimpleApplicationPullSinkPose()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkPose()
 	{}
 
+public:
 	/**
 	 * Retrieves current pose data with the given timestamp
 	 *
@@ -459,6 +743,71 @@ public:
 	 * @return true if successfull
 	 */
 	virtual bool getPose( SimplePose & pose, unsigned long long int timestamp ) = 0;
+
+	/**
+	 * Retrieves pose data like getPose, but without throwing, logging or formatting an
+	 * error message on failure. Use this while waiting for the first measurements.
+	 *
+	 * @param pose Pose data is returned in this object if the result is PULL_OK or PULL_STALE
+	 * @param timestamp Timestamp for which measurement shall be retrieved
+	 * @return the status of the request
+	 */
+	virtual SimplePullStatus tryGetPose( SimplePose & pose, unsigned long long int timestamp ) = 0;
+
+	/**
+	 * Retrieves the poses for the timestamps t0, t0 + stepNs, ... up to t1 in one call.
+	 * Timestamps for which the sink cannot deliver a pose are skipped, so the timestamps
+	 * of the returned poses tell which samples are present.
+	 *
+	 * @param t0 first timestamp
+	 * @param t1 last timestamp
+	 * @param stepNs distance of the timestamps in nanoseconds, must not be 0
+	 * @param pPoses caller-owned array receiving up to \p nMax poses
+	 * @param nMax size of \p pPoses
+	 * @return number of poses written or -1 if the arguments are invalid
+	 */
+	virtual int getPoseRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimplePose* pPoses, unsigned int nMax ) = 0;
+
+	/**
+	 * Enables the prediction of poses for the latency compensation of displays.
+	 * If the sink answers getPose or tryGetPose with a pose older than the requested
+	 * timestamp, which an ApplicationBufferedPullSink does for timestamps after its newest
+	 * measurement, the pose is predicted with constant velocity and constant angular
+	 * velocity. The velocities are fitted to the last four distinct poses this proxy delivered
+	 * within \p windowNs before the current one, no further poses are pulled from the sink.
+	 * The timestamp of the result tells how far the pose was predicted. Disabled by default.
+	 * Other pull sinks always answer with the requested timestamp, so the call fails for them.
+	 *
+	 * @param maxHorizonNs maximum prediction after the newest pose in nanoseconds, 0 disables the prediction
+	 * @param windowNs length of the history used to estimate the velocities in nanoseconds
+	 * @return false if the sink is no ApplicationBufferedPullSink, see getLastError
+	 */
+	virtual bool setExtrapolation( unsigned long long int maxHorizonNs, unsigned long long int windowNs = 40000000ULL ) = 0;
+
+	/**
+	 * Schedules a pull for a timestamp known in advance, e.g. the display time of the next
+	 * frame, on the background thread of the facade. The result is fetched with collectPose.
+	 * The results of the last four requested timestamps are kept.
+	 *
+	 * @param timestamp Timestamp for which measurement shall be retrieved
+	 */
+	virtual void requestPose( unsigned long long int timestamp ) = 0;
+
+	/**
+	 * Returns the result of requestPose without blocking.
+	 *
+	 * @param timestamp the timestamp passed to requestPose
+	 * @param pose Pose data is returned in this object if the result is PULL_OK or PULL_STALE
+	 * @return PULL_PENDING if the pull has not finished yet, PULL_ERROR if the timestamp was not requested
+	 */
+	virtual SimplePullStatus collectPose( unsigned long long int timestamp, SimplePose & pose ) = 0;
+
+	/**
+	 * returns the description of the last failed request of the calling thread or 0 if there was none.
+	 * The text is formatted on demand and stays valid until the thread uses this sink again.
+	 */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkErrorPose {
@@ -466,11 +815,11 @@ protected:
 	SimpleApplicationPullSinkErrorPose()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkErrorPose()
 	{}
 
+public:
 	/**
 	 * Retrieves current pose data with the given timestamp
 	 *
@@ -479,6 +828,22 @@ public:
 	 * @return true if successfull
 	 */
 	virtual bool getPose( SimpleErrorPose & pose, unsigned long long int timestamp ) = 0;
+
+	/** like getPose, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetPose( SimpleErrorPose & pose, unsigned long long int timestamp ) = 0;
+
+	/** retrieves the poses of a timestamp series, see SimpleApplicationPullSinkPose::getPoseRange */
+	virtual int getPoseRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimpleErrorPose* pPoses, unsigned int nMax ) = 0;
+
+	/** schedules a pull in the background, see SimpleApplicationPullSinkPose::requestPose */
+	virtual void requestPose( unsigned long long int timestamp ) = 0;
+
+	/** returns the result of requestPose without blocking, see SimpleApplicationPullSinkPose::collectPose */
+	virtual SimplePullStatus collectPose( unsigned long long int timestamp, SimpleErrorPose & pose ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkMatrix3x3 {
@@ -486,12 +851,18 @@ protected:
 	SimpleApplicationPullSinkMatrix3x3()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkMatrix3x3()
 	{}
 
+public:
 	virtual bool getMatrix3x3( SimpleMatrix3x3 & matrix, unsigned long long int timestamp ) = 0;
+
+	/** like getMatrix3x3, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetMatrix3x3( SimpleMatrix3x3 & matrix, unsigned long long int timestamp ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkMatrix4x4 {
@@ -499,12 +870,18 @@ protected:
 	SimpleApplicationPullSinkMatrix4x4()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkMatrix4x4()
 	{}
 
+public:
 	virtual bool getMatrix4x4( SimpleMatrix4x4 & matrix, unsigned long long int timestamp ) = 0;
+
+	/** like getMatrix4x4, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetMatrix4x4( SimpleMatrix4x4 & matrix, unsigned long long int timestamp ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkPosition3D {
@@ -512,12 +889,25 @@ protected:
 	SimpleApplicationPullSinkPosition3D()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkPosition3D()
 	{}
-	
+
+public:	
 	virtual bool getPosition3D( SimplePosition3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** like getPosition3D, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetPosition3D( SimplePosition3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** retrieves the positions of a timestamp series, see SimpleApplicationPullSinkPose::getPoseRange */
+	virtual int getPosition3DRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimplePosition3D* pPositions, unsigned int nMax ) = 0;
+
+	/** enables the prediction of positions with constant velocity, see SimpleApplicationPullSinkPose::setExtrapolation */
+	virtual bool setExtrapolation( unsigned long long int maxHorizonNs, unsigned long long int windowNs = 40000000ULL ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkErrorPosition3D {
@@ -525,12 +915,18 @@ protected:
 	SimpleApplicationPullSinkErrorPosition3D()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkErrorPosition3D()
 	{}
 
+public:
 	virtual bool getErrorPosition3D( SimpleErrorPosition3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** like getErrorPosition3D, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetErrorPosition3D( SimpleErrorPosition3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkPositionList3D {
@@ -538,12 +934,30 @@ protected:
 	SimpleApplicationPullSinkPositionList3D()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkPositionList3D()
 	{}
-	
+
+public:	
+	/** pulls the list for the given timestamp. The values of \p pos are overwritten, so passing the same list on every call reuses its storage. */
 	virtual bool getPositionList3D( SimplePositionList3D & pos, unsigned long long int timestamp ) = 0;
+
+	/**
+	 * Pulls the list for the given timestamp into a caller-owned buffer without allocating.
+	 *
+	 * @param pPositions buffer of 3 * \p nCapacity doubles receiving x, y, z of each position
+	 * @param nCapacity number of positions that fit into \p pPositions
+	 * @param timestamp Timestamp for which measurement shall be retrieved
+	 * @return number of positions in the list, which may be larger than \p nCapacity.
+	 * In that case only the first \p nCapacity positions are written. -1 on error.
+	 */
+	virtual int getPositionList3D( double* pPositions, unsigned int nCapacity, unsigned long long int timestamp ) = 0;
+
+	/** like getPositionList3D, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetPositionList3D( SimplePositionList3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 class SimpleApplicationPullSinkErrorPositionList3D {
@@ -551,12 +965,28 @@ protected:
 	SimpleApplicationPullSinkErrorPositionList3D()
 	{}
 
-public:
-	/** virtual destructor */
+	/** owned by the SimpleFacade, which deletes it together with itself */
 	virtual ~SimpleApplicationPullSinkErrorPositionList3D()
 	{}
 
+public:
+	/** pulls the list for the given timestamp. The values of \p pos are overwritten, so passing the same list on every call reuses its storage. */
 	virtual bool getErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp ) = 0;
+
+	/**
+	 * Pulls the list for the given timestamp into caller-owned buffers without allocating,
+	 * see SimpleApplicationPullSinkPositionList3D::getPositionList3D.
+	 *
+	 * @param pCovariances NULL or buffer of 9 * \p nCapacity doubles receiving the row major covariance of each position
+	 */
+	virtual int getErrorPositionList3D( double* pPositions, double* pCovariances, unsigned int nCapacity,
+		unsigned long long int timestamp ) = 0;
+
+	/** like getErrorPositionList3D, but reports failures with a status code instead of logging them */
+	virtual SimplePullStatus tryGetErrorPositionList3D( SimpleErrorPositionList3D & pos, unsigned long long int timestamp ) = 0;
+
+	/** returns the description of the last failed request of the calling thread or 0 if there was none */
+	virtual const char* getLastError() = 0;
 };
 
 
@@ -32,7 +32,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <typeinfo>
 #include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
 #include <log4cpp/Category.hh>
 
 #include "../utComponents/ApplicationPullSink.h"
@@ -45,136 +49,14 @@
 #include "AdvancedFacade.h"
 #include "DataflowObserver.h"
 #include "SimpleApplicationPrivate.h"
+#include "Trace.h"
+#include "Clock.h"
 // get a logger
 static log4cpp::Category& logger( log4cpp::Category::getInstance( "Ubitrack.Facade.SimpleFacade" ) );
 
 
 namespace {
 
-// this function converts Measurement::Pose to SimplePose in a callback
-void convertPoseCallback( Ubitrack::Facade::SimplePoseReceiver* receiver, const Ubitrack::Measurement::Pose& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimplePose p;
-	p.tx = measurement->translation()( 0 );
-	p.ty = measurement->translation()( 1 );
-	p.tz = measurement->translation()( 2 );
-	p.rx = measurement->rotation().x();
-	p.ry = measurement->rotation().y();
-	p.rz = measurement->rotation().z();
-	p.rw = measurement->rotation().w();
-	p.timestamp = measurement.time();
-	receiver->receivePose( p );
-}
-
-// this function converts Measurement::Pose to SimplePose in a callback
-void convertErrorPoseCallback( Ubitrack::Facade::SimpleErrorPoseReceiver* receiver, const Ubitrack::Measurement::ErrorPose& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimpleErrorPose p;
-	p.tx = measurement->translation()( 0 );
-	p.ty = measurement->translation()( 1 );
-	p.tz = measurement->translation()( 2 );
-	p.rx = measurement->rotation().x();
-	p.ry = measurement->rotation().y();
-	p.rz = measurement->rotation().z();
-	p.rw = measurement->rotation().w();
-	
-	p.co11 = measurement->covariance()(0, 0); p.co12 = measurement->covariance()(0, 1); p.co13 = measurement->covariance()(0, 2);
-	p.co14 = measurement->covariance()(0, 3); p.co15 = measurement->covariance()(0, 4); p.co16 = measurement->covariance()(0, 5);
-
-	p.co21 = measurement->covariance()(1, 0); p.co22 = measurement->covariance()(1, 1); p.co23 = measurement->covariance()(1, 2);
-	p.co24 = measurement->covariance()(1, 3); p.co25 = measurement->covariance()(1, 4); p.co26 = measurement->covariance()(1, 5);
-
-	p.co31 = measurement->covariance()(2, 0); p.co32 = measurement->covariance()(2, 1); p.co33 = measurement->covariance()(2, 2);
-	p.co34 = measurement->covariance()(2, 3); p.co35 = measurement->covariance()(2, 4); p.co36 = measurement->covariance()(2, 5);
-
-	p.co41 = measurement->covariance()(3, 0); p.co42 = measurement->covariance()(3, 1); p.co43 = measurement->covariance()(3, 2);
-	p.co44 = measurement->covariance()(3, 3); p.co45 = measurement->covariance()(3, 4); p.co46 = measurement->covariance()(3, 5);
-
-	p.co51 = measurement->covariance()(4, 0); p.co52 = measurement->covariance()(4, 1); p.co53 = measurement->covariance()(4, 2);
-	p.co54 = measurement->covariance()(4, 3); p.co55 = measurement->covariance()(4, 4); p.co56 = measurement->covariance()(4, 5);
-
-	p.co61 = measurement->covariance()(5, 0); p.co62 = measurement->covariance()(5, 1); p.co63 = measurement->covariance()(5, 2);
-	p.co64 = measurement->covariance()(5, 3); p.co65 = measurement->covariance()(5, 4); p.co66 = measurement->covariance()(5, 5);	
-	
-	p.timestamp = measurement.time();
-	receiver->receiveErrorPose( p );
-}
-
-// this function converts Measurement::Matrix3x4 to SimpleMatrix3x4 in a callback
-void convertMatrix3x4Callback( Ubitrack::Facade::SimpleMatrix3x4Receiver* receiver, const Ubitrack::Measurement::Matrix3x4& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimpleMatrix3x4 p;
-	p.e11 = (*measurement)(0,0);
-	p.e21 = (*measurement)(1,0);
-	p.e31 = (*measurement)(2,0);
-	p.e12 = (*measurement)(0,1);
-	p.e22 = (*measurement)(1,1);
-	p.e32 = (*measurement)(2,1);
-	p.e13 = (*measurement)(0,2);
-	p.e23 = (*measurement)(1,2);
-	p.e33 = (*measurement)(2,2);
-	p.e14 = (*measurement)(0,3);
-	p.e24 = (*measurement)(1,3);
-	p.e34 = (*measurement)(2,3);
-	p.timestamp = measurement.time();
-	LOG4CPP_INFO( logger, "Trying to send 3x4 Matrix at timestamp: " << p.timestamp );
-	receiver->receiveMatrix3x4( p );
-}
-
-// this function converts Measurement::Matrix4x4 to SimpleMatrix4x4 in a callback
-void convertMatrix4x4Callback( Ubitrack::Facade::SimpleMatrix4x4Receiver* receiver, const Ubitrack::Measurement::Matrix4x4& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimpleMatrix4x4 p;
-	
-	memcpy(p.values,measurement->content() , 16*sizeof(double));		
-	
-	p.timestamp = measurement.time();
-	LOG4CPP_INFO( logger, "Trying to send 4x4 Matrix at timestamp: " << p.timestamp );	
-	receiver->receiveMatrix4x4( p );
-}
-
-// this function converts Measurement::Distance to SimpleDistance in a callback
-void convertDistanceCallback( Ubitrack::Facade::SimpleDistanceReceiver* receiver, const Ubitrack::Measurement::Distance& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimpleDistance d;
-	d.d = *measurement;
-	d.timestamp = measurement.time();
-	receiver->receiveDistance( d );
-}
-
-void convertPosition2DCallback( Ubitrack::Facade::SimplePosition2DReceiver* receiver, const Ubitrack::Measurement::Position2D& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimplePosition2D p;
-	p.x = (*measurement)(0);
-	p.y = (*measurement)(1);
-	p.timestamp = measurement.time();
-	receiver->receivePosition2D( p );
-}
-
-void convert2DPositionListCallback( Ubitrack::Facade::SimplePosition2DListReceiver* receiver, const Ubitrack::Measurement::PositionList2& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimplePosition2DList p;
-	const std::size_t count( measurement->size() );
-	for( std::size_t i( 0 ); i<count; i++ )
-	{
-		SimplePosition2DValue value;
-		Math::Vector< double, 2 >  v2 = (*measurement)[i];
-		value.x = v2[0];
-		value.y = v2[1];
-		p.values.push_back(value);
-	}
-	
-	p.timestamp = measurement.time();
-	receiver->receivePosition2DList(p);
-}
-
 #ifdef HAVE_OPENCV
 // this function converts Measurement::ImageMeasurements to SimpleImage in a callback
 void convertImageCallback( Ubitrack::Facade::SimpleImageReceiver* receiver, const Ubitrack::Measurement::ImageMeasurement& measurement )
@@ -198,76 +80,6 @@ void convertImageCallback( Ubitrack::Facade::SimpleImageReceiver* receiver, cons
 
 }
 
-void convert3DPositionCallback( Ubitrack::Facade::SimplePosition3DReceiver* receiver, const Ubitrack::Measurement::Position& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimplePosition3D value;
-	
-	value.x = (*measurement)[0];
-	value.y = (*measurement)[1];
-	value.z = (*measurement)[2];
-	
-	value.timestamp = measurement.time();
-	receiver->receivePosition3D(value);
-}
-
-void convert3DErrorPositionCallback( Ubitrack::Facade::SimpleErrorPosition3DReceiver* receiver, const Ubitrack::Measurement::ErrorPosition& measurement )
-{
-	using namespace Ubitrack;	
-	
-	Facade::SimpleErrorPosition3D value;	
-	
-	Math::Vector< double, 3 >  v3 = measurement->value;
-	value.x = v3[0];
-	value.y = v3[1];
-	value.z = v3[2];
-	memcpy(value.covariance, measurement->covariance.content(), sizeof(double)*9);
-	value.timestamp = measurement.time();
-	receiver->receiveErrorPosition3D(value);
-}
-
-void convert3DPositionListCallback( Ubitrack::Facade::SimplePositionList3DReceiver* receiver, const Ubitrack::Measurement::PositionList& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimplePositionList3D p;
-	const std::size_t count( measurement->size() );
-	for( std::size_t i( 0 ); i<count; i++ )
-	{
-		SimplePosition3DValue value;
-		Math::Vector< double, 3 >  v3 = (*measurement)[i];
-		value.x = v3[0];
-		value.y = v3[1];
-		value.z = v3[2];
-		p.values.push_back(value);
-	}
-	
-	p.timestamp = measurement.time();
-	receiver->receivePositionList3D(p);
-}
-
-void convert3DErrorPositionListCallback( Ubitrack::Facade::SimpleErrorPositionList3DReceiver* receiver, const Ubitrack::Measurement::ErrorPositionList& measurement )
-{
-	using namespace Ubitrack;
-	Facade::SimpleErrorPositionList3D p;
-	const std::size_t count( measurement->size() );
-	for( std::size_t i( 0 ); i<count; i++ )
-	{
-		SimpleErrorPosition3DValue value;
-		Math::Vector< double, 3 >  v3 = (*measurement)[i].value;
-		value.x = v3[0];
-		value.y = v3[1];
-		value.z = v3[2];
-		
-		memcpy(value.covariance, (*measurement)[i].covariance.content(), sizeof(double)*9)		;
-		
-		p.values.push_back(value);
-	}
-	
-	p.timestamp = measurement.time();
-	receiver->receiveErrorPositionList3D(p);
-}
-
-
 
 namespace Ubitrack { namespace Facade {
 
@@ -283,6 +95,9 @@ public:
 	SimpleFacadePrivate( const char* sComponentPath )
 		: AdvancedFacade( sComponentPath ? sComponentPath : std::string() )
 		, m_pSimpleObserver( 0 )
+		, m_nLatestValues( 0 )
+		, m_nDataflowGeneration( 0 )
+		, m_pullSinkContext( *this, m_nDataflowGeneration, m_prefetcher )
 	{}
 
 	// translate from DataflowObserver to SimpleDataflowObserver
@@ -298,7 +113,304 @@ public:
 			m_pSimpleObserver->notifyDeleteComponent( sPatternName.c_str(), sComponentName.c_str() );
 	}
 	
+	/** returns the snapshot handle of a pose pull sink, adding it if necessary */
+	int snapshotHandle( const std::string& sName )
+	{
+		boost::unique_lock< boost::shared_mutex > lock( m_snapshotMutex );
+		for ( std::size_t i = 0; i < m_snapshotSinks.size(); i++ )
+			if ( m_snapshotSinks[ i ].sName == sName )
+			{
+				resolveSnapshotSink( m_snapshotSinks[ i ] );
+				return static_cast< int >( i );
+			}
+
+		SnapshotSink sink;
+		sink.sName = sName;
+		resolveSnapshotSink( sink );
+		if ( sink.pPose.expired() && sink.pErrorPose.expired() )
+			UBITRACK_THROW( "No pose pull sink with name " + sName );
+
+		m_snapshotSinks.push_back( sink );
+		return static_cast< int >( m_snapshotSinks.size() - 1 );
+	}
+
+	/**
+	 * Returns the interned pull sink proxy for a component, creating it on the first request.
+	 * Throws if the current dataflow has no such component.
+	 */
+	template< class ProxyPrivate >
+	ProxyPrivate* pullSinkProxy( const char* sName )
+	{
+		boost::mutex::scoped_lock lock( m_pullSinkMutex );
+		const PullSinkProxyKey key = { &typeid( ProxyPrivate ), sName };
+		PullSinkProxies::iterator it( std::lower_bound( m_pullSinkProxies.begin(), m_pullSinkProxies.end(), key, PullSinkProxyLess() ) );
+		if ( it == m_pullSinkProxies.end() || it->pType != key.pType || it->sName != sName )
+		{
+			// throws the usual error if the component does not exist
+			componentByName< typename ProxyPrivate::ComponentType >( sName );
+			PullSinkProxy entry;
+			entry.pType = key.pType;
+			entry.sName = sName;
+			entry.pProxy.reset( new ProxyPrivate( m_pullSinkContext, sName ) );
+			entry.rebind = &rebindPullSinkProxy< ProxyPrivate >;
+			it = m_pullSinkProxies.insert( it, entry );
+		}
+
+		ProxyPrivate* pProxy = static_cast< ProxyPrivate* >( it->pProxy.get() );
+		if ( !pProxy->bound() )
+			UBITRACK_THROW( "No pull sink with name " + std::string( sName ) + " in the current dataflow" );
+		return pProxy;
+	}
+
+	/** rebinds all proxies, so that they do not keep the components of a cleared dataflow alive */
+	void rebindPullSinkProxies()
+	{
+		boost::mutex::scoped_lock lock( m_pullSinkMutex );
+		for ( PullSinkProxies::iterator it( m_pullSinkProxies.begin() ); it != m_pullSinkProxies.end(); ++it )
+			it->rebind( it->pProxy.get() );
+	}
+
+	template< class ProxyPrivate >
+	static void rebindPullSinkProxy( void* pProxy )
+	{ static_cast< ProxyPrivate* >( pProxy )->bound(); }
+
+	/** to be called after a dataflow was loaded or cleared, lets the proxies and handles look up their components again */
+	void dataflowChanged()
+	{
+		m_nDataflowGeneration.fetch_add( 1, boost::memory_order_release );
+		rebindPullSinkProxies();
+		resolveSnapshotSinks();
+		attachLatestValues();
+	}
+
+	/** returns the latest value handle of a push sink, creating its slot if necessary */
+	int latestValueHandle( const std::string& sName )
+	{
+		boost::mutex::scoped_lock lock( m_latestValueMutex );
+		const std::size_t nCount( m_nLatestValues.load( boost::memory_order_relaxed ) );
+		for ( std::size_t i = 0; i < nCount; i++ )
+			if ( m_latestValues[ i ].sName == sName )
+				return static_cast< int >( i );
+
+		if ( nCount == s_nMaxLatestValues )
+			UBITRACK_THROW( "Too many latest value handles" );
+
+		boost::shared_ptr< Components::ApplicationPushSinkBase > pSink( componentByName< Components::ApplicationPushSinkBase >( sName ) );
+		boost::shared_ptr< Components::SeqlockSlotBase > pSlot( pSink->createLatestValueSlot() );
+		pSink->setLatestValueSlot( pSlot );
+
+		// readers only look at entries below the count, so the entry is complete before it is published
+		m_latestValues[ nCount ].sName = sName;
+		m_latestValues[ nCount ].pSlot = pSlot;
+		m_nLatestValues.store( nCount + 1, boost::memory_order_release );
+		return static_cast< int >( nCount );
+	}
+
+	/** reads the latest value of a handle without locking, false if there is none or the type does not match */
+	template< class T >
+	bool readLatest( int nHandle, T& value ) const
+	{
+		if ( nHandle < 0 || static_cast< std::size_t >( nHandle ) >= m_nLatestValues.load( boost::memory_order_acquire ) )
+			return false;
+
+		const Components::SeqlockSlotBase* pSlot( m_latestValues[ nHandle ].pSlot.get() );
+		if ( pSlot->type() != typeid( T ) )
+			return false;
+		return static_cast< const Components::SeqlockSlot< T >* >( pSlot )->read( value );
+	}
+
+	/** looks up the components of all snapshot handles again, e.g. after a new dataflow was loaded */
+	void resolveSnapshotSinks()
+	{
+		boost::unique_lock< boost::shared_mutex > lock( m_snapshotMutex );
+		for ( std::size_t i = 0; i < m_snapshotSinks.size(); i++ )
+			resolveSnapshotSink( m_snapshotSinks[ i ] );
+	}
+
+	/**
+	 * Pulls the sinks of a snapshot. Exactly one of \p pPoses and \p pErrorPoses must be set.
+	 * @return number of sinks pulled successfully
+	 */
+	int pullSnapshot( const int* pHandles, unsigned int nCount, Measurement::Timestamp t,
+		SimplePose* pPoses, SimpleErrorPose* pErrorPoses, SimplePullStatus* pStatus )
+	{
+		boost::shared_lock< boost::shared_mutex > lock( m_snapshotMutex );
+
+		int nOk = 0;
+		for ( unsigned int i = 0; i < nCount; i++ )
+		{
+			// a sink requested twice is only pulled once
+			unsigned int j = 0;
+			while ( j < i && pHandles[ j ] != pHandles[ i ] )
+				j++;
+
+			if ( j < i )
+			{
+				if ( pPoses )
+					pPoses[ i ] = pPoses[ j ];
+				else
+					pErrorPoses[ i ] = pErrorPoses[ j ];
+				pStatus[ i ] = pStatus[ j ];
+			}
+			else
+				pStatus[ i ] = pullSnapshotSink( pHandles[ i ], t, pPoses ? &pPoses[ i ] : 0, pErrorPoses ? &pErrorPoses[ i ] : 0 );
+
+			if ( pStatus[ i ] == PULL_OK )
+				nOk++;
+		}
+		return nOk;
+	}
+
 	SimpleDataflowObserver* m_pSimpleObserver;
+
+protected:
+	/** a pull sink that can be used in snapshots */
+	struct SnapshotSink
+	{
+		std::string sName;
+		boost::weak_ptr< Components::ApplicationPullSinkPose > pPose;
+		boost::weak_ptr< Components::ApplicationPullSinkErrorPose > pErrorPose;
+	};
+
+	void resolveSnapshotSink( SnapshotSink& sink )
+	{
+		sink.pPose.reset();
+		sink.pErrorPose.reset();
+
+		try
+		{
+			sink.pPose = componentByName< Components::ApplicationPullSinkPose >( sink.sName );
+		}
+		catch ( const Ubitrack::Util::Exception& )
+		{}
+
+		if ( !sink.pPose.expired() )
+			return;
+
+		try
+		{
+			sink.pErrorPose = componentByName< Components::ApplicationPullSinkErrorPose >( sink.sName );
+		}
+		catch ( const Ubitrack::Util::Exception& )
+		{}
+	}
+
+	/** pulls a single sink without throwing, \c m_snapshotMutex must be locked */
+	SimplePullStatus pullSnapshotSink( int nHandle, Measurement::Timestamp t, SimplePose* pPose, SimpleErrorPose* pErrorPose )
+	{
+		if ( nHandle < 0 || static_cast< std::size_t >( nHandle ) >= m_snapshotSinks.size() )
+			return PULL_ERROR;
+
+		const SnapshotSink& sink( m_snapshotSinks[ nHandle ] );
+		if ( boost::shared_ptr< Components::ApplicationPullSinkPose > pSink = sink.pPose.lock() )
+		{
+			if ( !pPose )
+				return PULL_ERROR;
+			Measurement::Pose measurement;
+			SimplePullStatus status( pSink->tryGet( t, measurement ) );
+			if ( status == PULL_OK || status == PULL_STALE )
+				convert( measurement, *pPose );
+			return status;
+		}
+
+		if ( boost::shared_ptr< Components::ApplicationPullSinkErrorPose > pSink = sink.pErrorPose.lock() )
+		{
+			Measurement::ErrorPose measurement;
+			SimplePullStatus status( pSink->tryGet( t, measurement ) );
+			if ( status == PULL_OK || status == PULL_STALE )
+			{
+				if ( pPose )
+					convert( measurement, *pPose );
+				else
+					convert( measurement, *pErrorPose );
+			}
+			return status;
+		}
+
+		return PULL_ERROR;
+	}
+
+	/** sets the slots of all latest value handles on the push sinks of the current dataflow */
+	void attachLatestValues()
+	{
+		boost::mutex::scoped_lock lock( m_latestValueMutex );
+		const std::size_t nCount( m_nLatestValues.load( boost::memory_order_relaxed ) );
+		for ( std::size_t i = 0; i < nCount; i++ )
+		{
+			// the slot keeps the last value of the old dataflow until the new sink receives an event
+			try
+			{
+				componentByName< Components::ApplicationPushSinkBase >( m_latestValues[ i ].sName )->setLatestValueSlot( m_latestValues[ i ].pSlot );
+			}
+			catch ( const Ubitrack::Util::Exception& )
+			{}
+		}
+	}
+
+	/** sinks registered with getPullSinkHandle, indexed by handle */
+	std::vector< SnapshotSink > m_snapshotSinks;
+
+	/** protects \c m_snapshotSinks, snapshots take a shared lock */
+	boost::shared_mutex m_snapshotMutex;
+
+	/** a push sink registered with getLatestValueHandle */
+	struct LatestValue
+	{
+		std::string sName;
+		boost::shared_ptr< Components::SeqlockSlotBase > pSlot;
+	};
+
+	/** maximum number of latest value handles, the table is never reallocated so that readers need no lock */
+	static const std::size_t s_nMaxLatestValues = 256;
+
+	/** latest value handles, entries below \c m_nLatestValues are never changed */
+	LatestValue m_latestValues[ s_nMaxLatestValues ];
+	boost::atomic< std::size_t > m_nLatestValues;
+
+	/** serializes adding and reattaching latest value handles */
+	boost::mutex m_latestValueMutex;
+
+	/** incremented whenever the dataflow is loaded or cleared */
+	boost::atomic< unsigned > m_nDataflowGeneration;
+
+	/** interned pull sink proxy */
+	struct PullSinkProxy
+	{
+		const std::type_info* pType;
+		std::string sName;
+		boost::shared_ptr< void > pProxy;
+
+		/** makes the proxy drop the component of the previous dataflow */
+		void ( *rebind )( void* pProxy );
+	};
+
+	/** lookup key of pullSinkProxy, refers to the requested name instead of copying it */
+	struct PullSinkProxyKey
+	{
+		const std::type_info* pType;
+		const char* sName;
+	};
+
+	/** orders the proxies by component name and proxy type */
+	struct PullSinkProxyLess
+	{
+		bool operator()( const PullSinkProxy& proxy, const PullSinkProxyKey& key ) const
+		{
+			int nOrder = strcmp( proxy.sName.c_str(), key.sName );
+			return nOrder < 0 || ( nOrder == 0 && proxy.pType->before( *key.pType ) );
+		}
+	};
+
+	/** interned pull sink proxies, sorted with PullSinkProxyLess */
+	typedef std::vector< PullSinkProxy > PullSinkProxies;
+	PullSinkProxies m_pullSinkProxies;
+	boost::mutex m_pullSinkMutex;
+
+	/** runs the requestPose calls of the proxies, declared after the proxies so that it is stopped first */
+	PullPrefetcher m_prefetcher;
+
+	/** passed to the proxies */
+	PullSinkContext m_pullSinkContext;
 };
 
 
@@ -311,51 +423,88 @@ class SimpleApplicationPullSinkPosePrivate
 	: public SimpleApplicationPullSinkPose {
 
 private:
-	/** dataflow component this proxy object represents */
-	Ubitrack::Components::ApplicationPullSinkPose * pSink;
+	/** dataflow component this proxy object represents, looked up again after the dataflow was reloaded */
+	PullSinkBinding< Ubitrack::Components::ApplicationPullSinkPose > m_sink;
 
-	/** content of the last error message */
-	char* m_sError;
+	/** last error of each thread */
+	PullSinkError m_error;
+
+	/** results of requestPose */
+	PullSinkPrefetch< Measurement::Pose, SimplePose > m_prefetch;
+
+	/** prediction of poses after the newest measurement */
+	PullSinkExtrapolation< Measurement::Pose, SimplePose > m_extrapolation;
 
 	/** sets the internal error string */
-	void setError( const char* sMsg ) throw();
+	void setError( const char* sMsg ) throw()
+	{ m_error.set( sMsg ); }
 
 
 public:
-	SimpleApplicationPullSinkPosePrivate( Ubitrack::Components::ApplicationPullSinkPose * pSink );
-	
-	~SimpleApplicationPullSinkPosePrivate();
+	/** type of the dataflow component */
+	typedef Ubitrack::Components::ApplicationPullSinkPose ComponentType;
+
+	SimpleApplicationPullSinkPosePrivate( const PullSinkContext& context, const std::string& sName );
 	
 	virtual bool getPose( SimplePose & pose, unsigned long long int timestamp );
-};
 
+	virtual SimplePullStatus tryGetPose( SimplePose & pose, unsigned long long int timestamp )
+	{
+		boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPose > pSink( m_sink.get() );
+		SimplePullStatus status( tryPullSink( pSink, m_sink.name(), pose, timestamp, m_error ) );
+		if ( status == PULL_OK )
+			m_extrapolation.apply( pSink, pose, timestamp );
+		return status;
+	}
 
+	virtual int getPoseRange( unsigned long long int t0, unsigned long long int t1, unsigned long long int stepNs,
+		SimplePose* pPoses, unsigned int nMax )
+	{ return pullSinkRange( m_sink.get(), t0, t1, stepNs, pPoses, nMax ); }
 
-SimpleApplicationPullSinkPosePrivate::SimpleApplicationPullSinkPosePrivate( Ubitrack::Components::ApplicationPullSinkPose * pSink )
-	: m_sError( 0 )
-{
-	this->pSink = pSink;
-}
+	virtual bool setExtrapolation( unsigned long long int maxHorizonNs, unsigned long long int windowNs = 40000000ULL )
+	{
+		if ( maxHorizonNs && !m_extrapolation.applicable( m_sink.get() ) )
+		{
+			setError( ( "Extrapolation needs an ApplicationBufferedPullSink, " + m_sink.name() + " is none" ).c_str() );
+			return false;
+		}
+		m_extrapolation.set( maxHorizonNs, windowNs );
+		return true;
+	}
 
+	virtual void requestPose( unsigned long long int timestamp )
+	{ m_prefetch.request( timestamp ); }
 
-SimpleApplicationPullSinkPosePrivate::~SimpleApplicationPullSinkPosePrivate()
-{
-	if ( m_sError )
-		free( m_sError );
-}
+	virtual SimplePullStatus collectPose( unsigned long long int timestamp, SimplePose & pose )
+	{ return m_prefetch.collect( timestamp, pose ); }
+
+	virtual const char* getLastError()
+	{ return m_error.get( m_sink.get() ); }
+
+	/** true if the component exists in the current dataflow */
+	bool bound()
+	{ return m_sink.bound(); }
+};
+
+
+
+SimpleApplicationPullSinkPosePrivate::SimpleApplicationPullSinkPosePrivate( const PullSinkContext& context, const std::string& sName )
+	: m_sink( context, sName )
+	, m_prefetch( m_sink, context.prefetcher )
+{}
 
 
 /** retrieves a pose for the given timestamp */
 bool SimpleApplicationPullSinkPosePrivate::getPose( SimplePose & pose, unsigned long long int timestamp )
 {
-	if ( pSink == NULL )
+	boost::shared_ptr< Ubitrack::Components::ApplicationPullSinkPose > pSink( m_sink.get() );
+	if ( !pSink )
 		return false;
 	
 	try {
-		LOG4CPP_INFO( logger, "Trying to pull pose in SimpleApplicationPullSinkPosePrivate::getPose() for timestamp: " << timestamp );
 		// Retrieve measurement for current timestamp
 		Ubitrack::Measurement::Pose p = pSink->get(timestamp);
-		LOG4CPP_INFO( logger, "Sucessfully pulled pose in SimpleApplicationPullSinkPosePrivate::getPose(): " << p );
+		UTFACADE_TRACE( PullSink, "Pose::getPose", pSink->getName().c_str(), timestamp );
 		// Convert measurement
 		pose.tx = p->translation()( 0 );
 		pose.ty = p->translation()( 1 );
@@ -365,6 +514,8 @@ bool SimpleApplicationPullSinkPosePrivate::getPose( SimplePose & pose, unsigned
 		pose.rz = p->rotation().z();
 		pose.rw = p->rotation().w();
 		pose.timestamp = p.time();
+
+		m_extrapolation.apply( pSink, pose, timestamp );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -377,14 +528,6 @@ bool SimpleApplicationPullSinkPosePrivate::getPose( SimplePose & pose, unsigned
 }
 
 
-void SimpleApplicationPullSinkPosePrivate::setError( const char* sMsg ) throw()
-{
-	if ( m_sError )
-		free( m_sError );
-	m_sError = strdup( sMsg );
-}
-
-
 SimpleFacade::SimpleFacade( const char* sComponentPath ) throw()
 	: m_pPrivate( 0 )
 	, m_sError( 0 )
@@ -411,7 +554,7 @@ SimpleFacade::~SimpleFacade()
 
 unsigned long long int SimpleFacade::now()
 {
-	return Measurement::now();
+	return Clock::now();
 }
 
 
@@ -420,6 +563,7 @@ bool SimpleFacade::loadDataflow( const char* sDfSrg ) throw()
 	try
 	{
 		m_pPrivate->loadDataflow( sDfSrg );
+		m_pPrivate->dataflowChanged();
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -438,6 +582,7 @@ bool SimpleFacade::loadDataflowString( const char* sDataflow ) throw()
 	{
 		std::istringstream ss( sDataflow );
 		m_pPrivate->loadDataflow( ss );
+		m_pPrivate->dataflowChanged();
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -456,6 +601,7 @@ void SimpleFacade::clearDataflow() throw()
 	{
 		// start the event queue
 		m_pPrivate->clearDataflow();
+		m_pPrivate->dataflowChanged();
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -495,6 +641,23 @@ void SimpleFacade::stopDataflow() throw()
 }
 
 
+bool SimpleFacade::setCallbackThreads( unsigned int nThreads ) throw()
+{
+	try
+	{
+		m_pPrivate->setCallbackThreads( nThreads );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setCallbackThreads: " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
 void SimpleFacade::connectToServer( const char* sAddress ) throw()
 {
 	try
@@ -541,7 +704,7 @@ bool SimpleFacade::setPoseCallback( const char* sCallbackName, SimplePoseReceive
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::Pose >( sCallbackName, boost::bind( &convertPoseCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Pose >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -557,7 +720,7 @@ bool SimpleFacade::setErrorPoseCallback( const char* sCallbackName, SimpleErrorP
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::ErrorPose >( sCallbackName, boost::bind( &convertErrorPoseCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::ErrorPose >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -573,7 +736,7 @@ bool SimpleFacade::setMatrix3x4Callback( const char* sCallbackName, SimpleMatrix
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::Matrix3x4 >( sCallbackName, boost::bind( &convertMatrix3x4Callback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Matrix3x4 >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -589,7 +752,7 @@ bool SimpleFacade::setMatrix4x4Callback( const char* sCallbackName, SimpleMatrix
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::Matrix4x4 >( sCallbackName, boost::bind( &convertMatrix4x4Callback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Matrix4x4 >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -605,7 +768,7 @@ bool SimpleFacade::setDistanceCallback( const char* sCallbackName, SimpleDistanc
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::Distance >( sCallbackName, boost::bind( &convertDistanceCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Distance >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -634,12 +797,27 @@ bool SimpleFacade::setStringCallback( const char* sCallbackName, SimpleStringRec
 	return true;
 }
 
+bool SimpleFacade::setBinaryCallback( const char* sCallbackName, SimpleBinaryReceiver* pCallback ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sCallbackName )->setBinaryCallback( pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setBinaryCallback( " << sCallbackName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
 bool SimpleFacade::setPosition2DCallback( const char* sCallbackName, SimplePosition2DReceiver* pCallback ) throw()
 {
 	try
 	{
-		//m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sCallbackName )->setPosition2DCallback( pCallback );
-		m_pPrivate->setCallback< Measurement::Position2D >( sCallbackName, boost::bind( &convertPosition2DCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Position2D >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -655,7 +833,7 @@ bool SimpleFacade::setPosition2DListCallback( const char* sCallbackName, SimpleP
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::PositionList2 >( sCallbackName, boost::bind( &convert2DPositionListCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::PositionList2 >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -689,7 +867,7 @@ bool SimpleFacade::set3DPositionCallback( const char* sCallbackName, SimplePosit
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::Position >( sCallbackName, boost::bind( &convert3DPositionCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::Position >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -705,7 +883,7 @@ bool SimpleFacade::set3DErrorPositionCallback( const char* sCallbackName, Simple
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::ErrorPosition >( sCallbackName, boost::bind( &convert3DErrorPositionCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::ErrorPosition >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -721,7 +899,7 @@ bool SimpleFacade::set3DPositionListCallback( const char* sCallbackName, SimpleP
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::PositionList >( sCallbackName, boost::bind( &convert3DPositionListCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::PositionList >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -737,7 +915,7 @@ bool SimpleFacade::set3DErrorPositionListCallback( const char* sCallbackName, Si
 {
 	try
 	{
-		m_pPrivate->setCallback< Measurement::ErrorPositionList >( sCallbackName, boost::bind( &convert3DErrorPositionListCallback, pCallback, _1 ) );
+		m_pPrivate->setReceiver< Measurement::ErrorPositionList >( sCallbackName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
@@ -750,287 +928,872 @@ bool SimpleFacade::set3DErrorPositionListCallback( const char* sCallbackName, Si
 }
 
 
-
-SimplePosition2DReceiver* SimpleFacade::getPushSourcePosition2D( const char* sComponentName ) throw()
+bool SimpleFacade::setPoseBatchCallback( const char* sCallbackName, SimplePoseBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-		return m_pPrivate->componentByName< Components::ApplicationPushSourcePosition2D >( sComponentName ).get();
+		m_pPrivate->setBatchReceiver< Measurement::Pose >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition2D( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setPoseBatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
+
+	return true;
 }
 
-SimplePosition3DReceiver* SimpleFacade::getPushSourcePosition3D( const char* sComponentName ) throw()
+bool SimpleFacade::setErrorPoseBatchCallback( const char* sCallbackName, SimpleErrorPoseBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-		LOG4CPP_INFO( logger, "Trying to get SimpleFacade::getPushSourcePosition3D for "<<sComponentName);
-		SimplePosition3DReceiver* result = m_pPrivate->componentByName< Components::ApplicationPushSourcePosition >( sComponentName ).get();
-		LOG4CPP_INFO( logger, "Getting SimpleFacade::getPushSourcePosition3D  "<<result);
-		return result;
+		m_pPrivate->setBatchReceiver< Measurement::ErrorPose >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition3D( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setErrorPoseBatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
+
+	return true;
 }
 
-SimplePoseReceiver* SimpleFacade::getPushSourcePose( const char* sComponentName ) throw()
+bool SimpleFacade::setPosition2DBatchCallback( const char* sCallbackName, SimplePosition2DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-		return m_pPrivate->componentByName< Components::ApplicationPushSourcePose >( sComponentName ).get();
+		m_pPrivate->setBatchReceiver< Measurement::Position2D >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePose( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setPosition2DBatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
-}
-
 
+	return true;
+}
 
+bool SimpleFacade::set3DPositionBatchCallback( const char* sCallbackName, SimplePosition3DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
+{
+	try
+	{
+		m_pPrivate->setBatchReceiver< Measurement::Position >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::set3DPositionBatchCallback( " << sCallbackName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
 
+	return true;
+}
 
-SimpleButtonReceiver* SimpleFacade::getPushSourceButton( const char* sComponentName ) throw()
+bool SimpleFacade::set3DErrorPositionBatchCallback( const char* sCallbackName, SimpleErrorPosition3DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-	  SimpleButtonReceiver * pr = m_pPrivate->componentByName< Components::ApplicationPushSourceButton >( sComponentName ).get();
-	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourceButton " );
-	  return pr;
+		m_pPrivate->setBatchReceiver< Measurement::ErrorPosition >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceButton( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::set3DErrorPositionBatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
-}
 
+	return true;
+}
 
-SimpleStringReceiver* SimpleFacade::getPushSourceString( const char* sComponentName ) throw()
+bool SimpleFacade::setMatrix3x4BatchCallback( const char* sCallbackName, SimpleMatrix3x4BatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-	  SimpleStringReceiver * pr = m_pPrivate->componentByName< SimpleStringReceiver >( sComponentName ).get();
-	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourceString " );
-	  return pr;
+		m_pPrivate->setBatchReceiver< Measurement::Matrix3x4 >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceString( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setMatrix3x4BatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
+
+	return true;
 }
 
-SimplePositionList3DReceiver* SimpleFacade::getPushSourcePositionList3D( const char* sComponentName ) throw()
+bool SimpleFacade::setMatrix4x4BatchCallback( const char* sCallbackName, SimpleMatrix4x4BatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
 	try
 	{
-	  SimplePositionList3DReceiver * pr = m_pPrivate->componentByName< SimplePositionList3DReceiver >( sComponentName ).get();
-	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourcePositionList3D " );
-	  return pr;
+		m_pPrivate->setBatchReceiver< Measurement::Matrix4x4 >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePositionList3D( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setMatrix4x4BatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
-}
 
+	return true;
+}
 
-SimpleApplicationPullSinkPose* SimpleFacade::getSimplePullSinkPose( const char* sComponentName ) throw()
+bool SimpleFacade::setDistanceBatchCallback( const char* sCallbackName, SimpleDistanceBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw()
 {
-	Ubitrack::Components::ApplicationPullSinkPose * pSink;
-
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkPose >( sComponentName ).get();
+		m_pPrivate->setBatchReceiver< Measurement::Distance >( sCallbackName, pCallback, nMaxEvents, nMaxDelayUs );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getSimplePullSinkPose( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setDistanceBatchCallback( " << sCallbackName <<" ): " << e );
 		setError( e.what() );
-		return 0;
+		return false;
 	}
 
-	// Create proxy object and return it
-	SimpleApplicationPullSinkPose * pSinkPriv = new SimpleApplicationPullSinkPosePrivate( pSink );
-
-	return pSinkPriv;
+	return true;
 }
 
-SimpleApplicationPullSinkErrorPose * SimpleFacade::getSimplePullSinkErrorPose( const char* sComponentName ) throw()
+unsigned int SimpleFacade::addPoseSubscriber( const char* sComponentName, SimplePoseReceiver* pCallback ) throw()
 {
-	Ubitrack::Components::ApplicationPullSinkErrorPose * pSink;
-
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkErrorPose >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::Pose >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getSimplePullSinkPose( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addPoseSubscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkErrorPose * pSinkPriv = new SimpleApplicationPullSinkErrorPosePrivate( pSink );
-
-	return pSinkPriv;
 }
 
-SimpleApplicationPullSinkMatrix3x3 * SimpleFacade::getPullSinkMatrix3x3( const char* sComponentName ) throw()
+unsigned int SimpleFacade::addErrorPoseSubscriber( const char* sComponentName, SimpleErrorPoseReceiver* pCallback ) throw()
 {
-	Ubitrack::Components::ApplicationPullSinkMatrix3x3 * pSink;
-
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkMatrix3x3 >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::ErrorPose >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkMatrix3x3( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addErrorPoseSubscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkMatrix3x3 * pSinkPriv = new SimpleApplicationPullSinkMatrix3x3Private( pSink );
-
-	return pSinkPriv;
 }
 
-SimpleApplicationPullSinkMatrix4x4 * SimpleFacade::getPullSinkMatrix4x4( const char* sComponentName ) throw()
+unsigned int SimpleFacade::addMatrix3x4Subscriber( const char* sComponentName, SimpleMatrix3x4Receiver* pCallback ) throw()
 {
-	Ubitrack::Components::ApplicationPullSinkMatrix4x4 * pSink;
-
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkMatrix4x4 >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::Matrix3x4 >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkMatrix4x4( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addMatrix3x4Subscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkMatrix4x4 * pSinkPriv = new SimpleApplicationPullSinkMatrix4x4Private( pSink );
-
-	return pSinkPriv;
 }
-	
-SimpleApplicationPullSinkPosition3D * SimpleFacade::getPullSinkPosition3D( const char* sComponentName ) throw()
-{
-	Ubitrack::Components::ApplicationPullSinkPosition * pSink;
 
+unsigned int SimpleFacade::addMatrix4x4Subscriber( const char* sComponentName, SimpleMatrix4x4Receiver* pCallback ) throw()
+{
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkPosition >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::Matrix4x4 >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkPosition3D( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addMatrix4x4Subscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkPosition3D * pSinkPriv = new SimpleApplicationPullSinkPosition3DPrivate( pSink );
-
-	return pSinkPriv;
 }
-SimpleApplicationPullSinkErrorPosition3D * SimpleFacade::getPullSinkErrorPosition3D( const char* sComponentName ) throw()
-{
-	Ubitrack::Components::ApplicationPullSinkErrorPosition * pSink;
 
+unsigned int SimpleFacade::addDistanceSubscriber( const char* sComponentName, SimpleDistanceReceiver* pCallback ) throw()
+{
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkErrorPosition >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::Distance >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkErrorPosition3D( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addDistanceSubscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkErrorPosition3D * pSinkPriv = new SimpleApplicationPullSinkErrorPosition3DPrivate( pSink );
-
-	return pSinkPriv;
 }
-SimpleApplicationPullSinkPositionList3D * SimpleFacade::getPullSinkPosition3DList( const char* sComponentName ) throw()
-{
-	Ubitrack::Components::ApplicationPullSinkPositionList * pSink;
 
+unsigned int SimpleFacade::addPosition2DSubscriber( const char* sComponentName, SimplePosition2DReceiver* pCallback ) throw()
+{
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkPositionList >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::Position2D >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkPosition3DList( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addPosition2DSubscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkPositionList3D * pSinkPriv = new SimpleApplicationPullSinkPositionList3DPrivate( pSink );
-
-	return pSinkPriv;
 }
-SimpleApplicationPullSinkErrorPositionList3D * SimpleFacade::getPullSinkErrorPosition3DList( const char* sComponentName ) throw()
-{
-	Ubitrack::Components::ApplicationPullSinkErrorPositionList * pSink;
 
+unsigned int SimpleFacade::addPosition2DListSubscriber( const char* sComponentName, SimplePosition2DListReceiver* pCallback ) throw()
+{
 	try
 	{
-		 pSink = m_pPrivate->componentByName< Components::ApplicationPullSinkErrorPositionList >( sComponentName ).get();
+		return m_pPrivate->addReceiver< Measurement::PositionList2 >( sComponentName, pCallback );
 	}
 	catch ( const Ubitrack::Util::Exception& e )
 	{
-		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkErrorPosition3DList( " << sComponentName <<" ): " << e );
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addPosition2DListSubscriber( " << sComponentName <<" ): " << e );
 		setError( e.what() );
 		return 0;
 	}
-
-	// Create proxy object and return it
-	SimpleApplicationPullSinkErrorPositionList3D * pSinkPriv = new SimpleApplicationPullSinkErrorPositionList3DPrivate( pSink );
-
-	return pSinkPriv;
 }
 
-
-void SimpleFacade::setDataflowObserver( SimpleDataflowObserver* pObserver ) throw()
+unsigned int SimpleFacade::add3DPositionSubscriber( const char* sComponentName, SimplePosition3DReceiver* pCallback ) throw()
 {
-	if ( !m_pPrivate->m_pSimpleObserver )
-		m_pPrivate->addDataflowObserver( m_pPrivate );
-	m_pPrivate->m_pSimpleObserver = pObserver;
+	try
+	{
+		return m_pPrivate->addReceiver< Measurement::Position >( sComponentName, pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::add3DPositionSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
 }
 
-	
-void SimpleFacade::removeDataflowObserver() throw()
+unsigned int SimpleFacade::add3DErrorPositionSubscriber( const char* sComponentName, SimpleErrorPosition3DReceiver* pCallback ) throw()
+{
+	try
+	{
+		return m_pPrivate->addReceiver< Measurement::ErrorPosition >( sComponentName, pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::add3DErrorPositionSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+unsigned int SimpleFacade::add3DPositionListSubscriber( const char* sComponentName, SimplePositionList3DReceiver* pCallback ) throw()
+{
+	try
+	{
+		return m_pPrivate->addReceiver< Measurement::PositionList >( sComponentName, pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::add3DPositionListSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+unsigned int SimpleFacade::add3DErrorPositionListSubscriber( const char* sComponentName, SimpleErrorPositionList3DReceiver* pCallback ) throw()
+{
+	try
+	{
+		return m_pPrivate->addReceiver< Measurement::ErrorPositionList >( sComponentName, pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::add3DErrorPositionListSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+unsigned int SimpleFacade::addStringSubscriber( const char* sComponentName, SimpleStringReceiver* pCallback ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->addStringSubscriber( pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addStringSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+unsigned int SimpleFacade::addBinarySubscriber( const char* sComponentName, SimpleBinaryReceiver* pCallback ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->addBinarySubscriber( pCallback );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::addBinarySubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+bool SimpleFacade::removeSubscriber( const char* sComponentName, unsigned int nHandle ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->removeSubscriber( nHandle );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::removeSubscriber( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+}
+
+int SimpleFacade::drainPushSink( const char* sComponentName, unsigned int nMaxEvents ) throw()
+{
+	try
+	{
+		return static_cast< int >( m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->drain( nMaxEvents ) );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::drainPushSink( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return -1;
+	}
+}
+
+bool SimpleFacade::getPushSinkStats( const char* sComponentName, SimplePushSinkStats& stats ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->getStatistics( stats );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSinkStats( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SimpleFacade::getSinkLatencyStats( const char* sComponentName, SimpleLatencyStats& stats, bool bReset ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->getLatencyStatistics( stats, bReset );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getSinkLatencyStats( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SimpleFacade::setPushSinkDeliveryPolicy( const char* sComponentName, SimpleDeliveryPolicy policy ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPushSinkBase >( sComponentName )->setDeliveryPolicy( 
+			policy == DELIVER_LATEST ? Components::ApplicationPushSinkBase::PolicyLatest : Components::ApplicationPushSinkBase::PolicyFifo );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setPushSinkDeliveryPolicy( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SimpleFacade::setPullSinkCacheSize( const char* sComponentName, unsigned int nEntries ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPullSinkBase >( sComponentName )->setCacheSize( nEntries );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::setPullSinkCacheSize( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SimpleFacade::getPullSinkCacheStats( const char* sComponentName, SimplePullCacheStats& stats, bool bReset ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPullSinkBase >( sComponentName )->getCacheStatistics( stats, bReset );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkCacheStats( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+
+SimplePosition2DReceiver* SimpleFacade::getPushSourcePosition2D( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourcePosition2D >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition2D( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimplePosition3DReceiver* SimpleFacade::getPushSourcePosition3D( const char* sComponentName ) throw()
+{
+	try
+	{
+		LOG4CPP_INFO( logger, "Trying to get SimpleFacade::getPushSourcePosition3D for "<<sComponentName);
+		SimplePosition3DReceiver* result = m_pPrivate->componentByName< Components::ApplicationPushSourcePosition >( sComponentName ).get();
+		LOG4CPP_INFO( logger, "Getting SimpleFacade::getPushSourcePosition3D  "<<result);
+		return result;
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition3D( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimplePoseReceiver* SimpleFacade::getPushSourcePose( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourcePose >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePose( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+
+
+
+
+SimpleButtonReceiver* SimpleFacade::getPushSourceButton( const char* sComponentName ) throw()
+{
+	try
+	{
+	  SimpleButtonReceiver * pr = m_pPrivate->componentByName< Components::ApplicationPushSourceButton >( sComponentName ).get();
+	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourceButton " );
+	  return pr;
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceButton( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimplePoseBatchReceiver* SimpleFacade::getPushSourcePoseBatch( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourcePose >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePoseBatch( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimplePosition2DBatchReceiver* SimpleFacade::getPushSourcePosition2DBatch( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourcePosition2D >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition2DBatch( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimplePosition3DBatchReceiver* SimpleFacade::getPushSourcePosition3DBatch( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourcePosition >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePosition3DBatch( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimpleButtonBatchReceiver* SimpleFacade::getPushSourceButtonBatch( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->componentByName< Components::ApplicationPushSourceButton >( sComponentName ).get();
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceButtonBatch( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+
+SimpleStringReceiver* SimpleFacade::getPushSourceString( const char* sComponentName ) throw()
+{
+	try
+	{
+	  SimpleStringReceiver * pr = m_pPrivate->componentByName< SimpleStringReceiver >( sComponentName ).get();
+	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourceString " );
+	  return pr;
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceString( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimpleBinaryReceiver* SimpleFacade::getPushSourceBinary( const char* sComponentName ) throw()
+{
+	try
+	{
+	  SimpleBinaryReceiver * pr = m_pPrivate->componentByName< SimpleBinaryReceiver >( sComponentName ).get();
+	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourceBinary " );
+	  return pr;
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceBinary( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+bool SimpleFacade::getPushSourceStats( const char* sComponentName, SimplePushSourceStats& stats ) throw()
+{
+	try
+	{
+		m_pPrivate->componentByName< Components::ApplicationPushSourceBase >( sComponentName )->getStatistics( stats );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourceStats( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return false;
+	}
+
+	return true;
+}
+
+SimplePositionList3DReceiver* SimpleFacade::getPushSourcePositionList3D( const char* sComponentName ) throw()
+{
+	try
+	{
+	  SimplePositionList3DReceiver * pr = m_pPrivate->componentByName< SimplePositionList3DReceiver >( sComponentName ).get();
+	  LOG4CPP_DEBUG( logger, "Successfully retrieved component " << sComponentName << " in SimpleFacade::getPushSourcePositionList3D " );
+	  return pr;
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPushSourcePositionList3D( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+
+SimpleApplicationPullSinkPose * SimpleFacade::getSimplePullSinkPose( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkPosePrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getSimplePullSinkPose( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimpleApplicationPullSinkErrorPose * SimpleFacade::getSimplePullSinkErrorPose( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkErrorPosePrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getSimplePullSinkPose( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimpleApplicationPullSinkMatrix3x3 * SimpleFacade::getPullSinkMatrix3x3( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkMatrix3x3Private >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkMatrix3x3( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+SimpleApplicationPullSinkMatrix4x4 * SimpleFacade::getPullSinkMatrix4x4( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkMatrix4x4Private >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkMatrix4x4( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+	
+SimpleApplicationPullSinkPosition3D * SimpleFacade::getPullSinkPosition3D( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkPosition3DPrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkPosition3D( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+SimpleApplicationPullSinkErrorPosition3D * SimpleFacade::getPullSinkErrorPosition3D( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkErrorPosition3DPrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkErrorPosition3D( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+SimpleApplicationPullSinkPositionList3D * SimpleFacade::getPullSinkPosition3DList( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkPositionList3DPrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkPosition3DList( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+int SimpleFacade::getLatestValueHandle( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->latestValueHandle( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getLatestValueHandle( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return -1;
+	}
+}
+
+
+bool SimpleFacade::readLatestPose( int nHandle, SimplePose& pose ) throw()
+{ return m_pPrivate->readLatest( nHandle, pose ); }
+
+bool SimpleFacade::readLatestErrorPose( int nHandle, SimpleErrorPose& pose ) throw()
+{ return m_pPrivate->readLatest( nHandle, pose ); }
+
+bool SimpleFacade::readLatestMatrix3x4( int nHandle, SimpleMatrix3x4& matrix ) throw()
+{ return m_pPrivate->readLatest( nHandle, matrix ); }
+
+bool SimpleFacade::readLatestMatrix4x4( int nHandle, SimpleMatrix4x4& matrix ) throw()
+{ return m_pPrivate->readLatest( nHandle, matrix ); }
+
+bool SimpleFacade::readLatestDistance( int nHandle, SimpleDistance& distance ) throw()
+{ return m_pPrivate->readLatest( nHandle, distance ); }
+
+bool SimpleFacade::readLatestPosition2D( int nHandle, SimplePosition2D& position ) throw()
+{ return m_pPrivate->readLatest( nHandle, position ); }
+
+bool SimpleFacade::readLatestPosition3D( int nHandle, SimplePosition3D& position ) throw()
+{ return m_pPrivate->readLatest( nHandle, position ); }
+
+bool SimpleFacade::readLatestErrorPosition3D( int nHandle, SimpleErrorPosition3D& position ) throw()
+{ return m_pPrivate->readLatest( nHandle, position ); }
+
+
+int SimpleFacade::getPullSinkHandle( const char* sComponentName ) throw()
+{
+	try
+	{
+		return m_pPrivate->snapshotHandle( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkHandle( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return -1;
+	}
+}
+
+
+int SimpleFacade::pullSnapshot( const int* pHandles, unsigned int nCount, unsigned long long int timestamp,
+	SimplePose* pPoses, SimplePullStatus* pStatus ) throw()
+{
+	if ( nCount && ( !pHandles || !pPoses || !pStatus ) )
+	{
+		setError( "SimpleFacade::pullSnapshot: NULL array" );
+		return -1;
+	}
+
+	try
+	{
+		return m_pPrivate->pullSnapshot( pHandles, nCount, timestamp, pPoses, 0, pStatus );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::pullSnapshot: " << e );
+		setError( e.what() );
+		return -1;
+	}
+}
+
+
+int SimpleFacade::pullErrorSnapshot( const int* pHandles, unsigned int nCount, unsigned long long int timestamp,
+	SimpleErrorPose* pPoses, SimplePullStatus* pStatus ) throw()
+{
+	if ( nCount && ( !pHandles || !pPoses || !pStatus ) )
+	{
+		setError( "SimpleFacade::pullErrorSnapshot: NULL array" );
+		return -1;
+	}
+
+	try
+	{
+		return m_pPrivate->pullSnapshot( pHandles, nCount, timestamp, 0, pPoses, pStatus );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::pullErrorSnapshot: " << e );
+		setError( e.what() );
+		return -1;
+	}
+}
+
+
+SimpleApplicationPullSinkErrorPositionList3D * SimpleFacade::getPullSinkErrorPosition3DList( const char* sComponentName ) throw()
+{
+	try
+	{
+		// proxies are interned, so repeated requests return the same object
+		return m_pPrivate->pullSinkProxy< SimpleApplicationPullSinkErrorPositionList3DPrivate >( sComponentName );
+	}
+	catch ( const Ubitrack::Util::Exception& e )
+	{
+		LOG4CPP_ERROR( logger, "Caught exception in SimpleFacade::getPullSinkErrorPosition3DList( " << sComponentName <<" ): " << e );
+		setError( e.what() );
+		return 0;
+	}
+}
+
+
+void SimpleFacade::setDataflowObserver( SimpleDataflowObserver* pObserver ) throw()
+{
+	if ( !m_pPrivate->m_pSimpleObserver )
+		m_pPrivate->addDataflowObserver( m_pPrivate );
+	m_pPrivate->m_pSimpleObserver = pObserver;
+}
+
+	
+void SimpleFacade::removeDataflowObserver() throw()
 {
 	m_pPrivate->removeDataflowObserver( m_pPrivate );
 	m_pPrivate->m_pSimpleObserver = 0;
 }
 
 
+bool SimpleFacade::setTraceSampling( const char* sCategory, unsigned int nEvery ) throw()
+{
+	if ( !sCategory )
+	{
+		for ( int i = 0; i < Trace::CategoryCount; i++ )
+			Trace::setSampling( static_cast< Trace::Category >( i ), nEvery );
+		return true;
+	}
+
+	Trace::Category category;
+	if ( !Trace::categoryFromName( sCategory, category ) )
+	{
+		std::ostringstream msg;
+		msg << "Unknown trace category " << sCategory;
+		setError( msg.str().c_str() );
+		return false;
+	}
+
+	Trace::setSampling( category, nEvery );
+	return true;
+}
+
+
 const char* SimpleFacade::getLastError() throw()
 {
 	if ( m_pPrivate )
@@ -73,6 +73,10 @@ public:
 	/** destroys the data flow */
 	~SimpleFacade();
 
+	/**
+	 * Returns the current time in nanoseconds since the unix epoch, the time base of all
+	 * measurements. Reads the time stamp counter where possible, see \c Clock::now().
+	 */
 	static unsigned long long int now();
 	
 	/** 
@@ -98,9 +102,22 @@ public:
 	/** starts components and the event queue */
 	void startDataflow() throw();
 	
-	/** stops components and the event queue */
+	/**
+	 * stops components and the event queue. Fails and sets the error when called from a
+	 * callback that runs on a queued or executor push sink, which cannot wait for itself.
+	 */
 	void stopDataflow() throw();
 
+	/**
+	 * Sets the number of threads that run the callbacks of push sinks configured with
+	 * deliveryMode "executor". Callbacks of different sinks run in parallel on these
+	 * threads, callbacks of one sink are always called in order.
+	 *
+	 * @param nThreads number of threads, at least 1
+	 * @return true if successful
+	 */
+	bool setCallbackThreads( unsigned int nThreads ) throw();
+
 
 	/** 
 	 * connect to a ubitrack server.
@@ -174,6 +191,16 @@ public:
 	 */
 	bool setStringCallback( const char* sComponentName, SimpleStringReceiver* pCallback ) throw();
 
+	/**
+	 * Sets a binary callback on an ApplicationPushSink.
+	 * The events are passed in the compact binary format described in BinaryCodec.h.
+	 *
+	 * @param sComponentName edge name of the ApplicationPushSink
+	 * @param pCallback the interface to call when an event is received
+	 * @return true if successful, false if the sink does not exist or its type has no binary format
+	 */
+	bool setBinaryCallback( const char* sComponentName, SimpleBinaryReceiver* pCallback ) throw();
+
 	/**
 	 * Sets a position 2d callback on an ApplicationPushSink
 	 *
@@ -201,6 +228,167 @@ public:
 	
 	bool set3DPositionListCallback( const char* sComponentName, SimplePositionList3DReceiver* pCallback ) throw();
 	bool set3DErrorPositionListCallback( const char* sComponentName, SimpleErrorPositionList3DReceiver* pCallback ) throw();
+
+	/**
+	 * Sets a batch callback on an ApplicationPushSinkPose. Poses are collected and passed
+	 * to the receiver in one call when \p nMaxEvents poses have been collected or the
+	 * first collected pose has waited for \p nMaxDelayUs microseconds. Replaces a
+	 * callback set with setPoseCallback and vice versa.
+	 * A delay window fails in synchronous delivery and on the callback executor,
+	 * because no thread would deliver a partial batch there before the next event.
+	 *
+	 * @param sComponentName edge name of the ApplicationPushSinkPose
+	 * @param pCallback the interface to call with the collected events
+	 * @param nMaxEvents maximum number of events per call
+	 * @param nMaxDelayUs maximum delay of an event in microseconds, 0 to only deliver full batches
+	 * @return true if successful
+	 */
+	bool setPoseBatchCallback( const char* sComponentName, SimplePoseBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool setErrorPoseBatchCallback( const char* sComponentName, SimpleErrorPoseBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool setPosition2DBatchCallback( const char* sComponentName, SimplePosition2DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool set3DPositionBatchCallback( const char* sComponentName, SimplePosition3DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool set3DErrorPositionBatchCallback( const char* sComponentName, SimpleErrorPosition3DBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool setMatrix3x4BatchCallback( const char* sComponentName, SimpleMatrix3x4BatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool setMatrix4x4BatchCallback( const char* sComponentName, SimpleMatrix4x4BatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+	bool setDistanceBatchCallback( const char* sComponentName, SimpleDistanceBatchReceiver* pCallback, unsigned int nMaxEvents, unsigned int nMaxDelayUs ) throw();
+
+	/**
+	 * Adds a pose receiver to an ApplicationPushSinkPose in addition to the receivers
+	 * already registered, so several consumers can share one sink. Each event is converted
+	 * once and passed to all receivers. Subscribers may be added and removed while the
+	 * dataflow is running.
+	 *
+	 * @param sComponentName edge name of the ApplicationPushSinkPose
+	 * @param pCallback the interface to call when an event is received
+	 * @return handle to pass to removeSubscriber, 0 on error
+	 */
+	unsigned int addPoseSubscriber( const char* sComponentName, SimplePoseReceiver* pCallback ) throw();
+	unsigned int addErrorPoseSubscriber( const char* sComponentName, SimpleErrorPoseReceiver* pCallback ) throw();
+	unsigned int addMatrix3x4Subscriber( const char* sComponentName, SimpleMatrix3x4Receiver* pCallback ) throw();
+	unsigned int addMatrix4x4Subscriber( const char* sComponentName, SimpleMatrix4x4Receiver* pCallback ) throw();
+	unsigned int addDistanceSubscriber( const char* sComponentName, SimpleDistanceReceiver* pCallback ) throw();
+	unsigned int addPosition2DSubscriber( const char* sComponentName, SimplePosition2DReceiver* pCallback ) throw();
+	unsigned int addPosition2DListSubscriber( const char* sComponentName, SimplePosition2DListReceiver* pCallback ) throw();
+	unsigned int add3DPositionSubscriber( const char* sComponentName, SimplePosition3DReceiver* pCallback ) throw();
+	unsigned int add3DErrorPositionSubscriber( const char* sComponentName, SimpleErrorPosition3DReceiver* pCallback ) throw();
+	unsigned int add3DPositionListSubscriber( const char* sComponentName, SimplePositionList3DReceiver* pCallback ) throw();
+	unsigned int add3DErrorPositionListSubscriber( const char* sComponentName, SimpleErrorPositionList3DReceiver* pCallback ) throw();
+	unsigned int addStringSubscriber( const char* sComponentName, SimpleStringReceiver* pCallback ) throw();
+	unsigned int addBinarySubscriber( const char* sComponentName, SimpleBinaryReceiver* pCallback ) throw();
+
+	/**
+	 * Removes a receiver added with one of the add*Subscriber functions.
+	 * Waits until deliveries that are already running have returned, so the receiver may be
+	 * freed after the call. When called from a callback of the same sink it returns at once,
+	 * and the running delivery may still call the receiver.
+	 *
+	 * @param sComponentName edge name of the ApplicationPushSink
+	 * @param nHandle handle returned when the receiver was added
+	 * @return true if successful
+	 */
+	bool removeSubscriber( const char* sComponentName, unsigned int nHandle ) throw();
+
+	/**
+	 * Delivers the queued events of an ApplicationPushSink configured with
+	 * deliveryMode="polled" to its callback on the calling thread.
+	 *
+	 * @param sComponentName name of the ApplicationPushSink
+	 * @param nMaxEvents maximum number of events to deliver, 0 delivers all queued events
+	 * @return number of delivered events or -1 on error
+	 */
+	int drainPushSink( const char* sComponentName, unsigned int nMaxEvents = 0 ) throw();
+
+	/**
+	 * Retrieves the delivery statistics of an ApplicationPushSink
+	 *
+	 * @param sComponentName name of the ApplicationPushSink
+	 * @param stats statistics are returned in this object on success
+	 * @return true if successful
+	 */
+	bool getPushSinkStats( const char* sComponentName, SimplePushSinkStats& stats ) throw();
+
+	/**
+	 * Retrieves the latency statistics of an ApplicationPushSink: the age of events
+	 * on arrival and the time spent in the callback.
+	 *
+	 * @param sComponentName name of the ApplicationPushSink
+	 * @param stats statistics are returned in this object on success
+	 * @param bReset start a new measurement period after reading the statistics
+	 * @return true if successful
+	 */
+	bool getSinkLatencyStats( const char* sComponentName, SimpleLatencyStats& stats, bool bReset = false ) throw();
+
+	/**
+	 * Sets the delivery policy of an ApplicationPushSink. DELIVER_LATEST switches a
+	 * synchronous sink to queued delivery. Must be called before the dataflow is started.
+	 *
+	 * @param sComponentName name of the ApplicationPushSink
+	 * @param policy the new delivery policy
+	 * @return true if successful, false if the sink is not found or already running
+	 */
+	bool setPushSinkDeliveryPolicy( const char* sComponentName, SimpleDeliveryPolicy policy ) throw();
+
+	/**
+	 * Makes an ApplicationPushSink publish the latest value it receives, so that it can be
+	 * polled with the readLatest* functions, e.g. once per frame of a game loop.
+	 * Requesting the same sink twice returns the same handle. Handles stay valid when a
+	 * dataflow is reloaded and refer to the sink with the same name. Sinks of list types
+	 * are not supported.
+	 *
+	 * @param sComponentName name of the ApplicationPushSink
+	 * @return the handle or -1 on error
+	 */
+	int getLatestValueHandle( const char* sComponentName ) throw();
+
+	/**
+	 * Reads the latest pose received by the sink of a handle returned by getLatestValueHandle.
+	 * Neither pulls from the dataflow nor takes a lock, and never blocks the sink.
+	 * Can be called from any thread.
+	 *
+	 * @return false if the sink has not received a pose yet or the handle does not refer to an ApplicationPushSinkPose
+	 */
+	bool readLatestPose( int nHandle, SimplePose& pose ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkErrorPose */
+	bool readLatestErrorPose( int nHandle, SimpleErrorPose& pose ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkMatrix3x4 */
+	bool readLatestMatrix3x4( int nHandle, SimpleMatrix3x4& matrix ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkMatrix4x4 */
+	bool readLatestMatrix4x4( int nHandle, SimpleMatrix4x4& matrix ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkDistance */
+	bool readLatestDistance( int nHandle, SimpleDistance& distance ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkPosition2D */
+	bool readLatestPosition2D( int nHandle, SimplePosition2D& position ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkPosition */
+	bool readLatestPosition3D( int nHandle, SimplePosition3D& position ) throw();
+
+	/** like readLatestPose for an ApplicationPushSinkErrorPosition */
+	bool readLatestErrorPosition3D( int nHandle, SimpleErrorPosition3D& position ) throw();
+
+	/**
+	 * Sets the number of results an ApplicationPullSink caches by timestamp.
+	 * Overrides the cacheSize attribute and clears the cache.
+	 *
+	 * @param sComponentName name of the ApplicationPullSink
+	 * @param nEntries number of cached results, 0 disables the cache
+	 * @return true if successful
+	 */
+	bool setPullSinkCacheSize( const char* sComponentName, unsigned int nEntries ) throw();
+
+	/**
+	 * Retrieves the cache hit and miss counters of an ApplicationPullSink
+	 *
+	 * @param sComponentName name of the ApplicationPullSink
+	 * @param stats statistics are returned in this object on success
+	 * @param bReset set the counters to 0 after reading them
+	 * @return true if successful
+	 */
+	bool getPullSinkCacheStats( const char* sComponentName, SimplePullCacheStats& stats, bool bReset = false ) throw();
 	
 	/**
 	 * Gets a pointer to a SimplePosition2DReceiver interface on a ApplicationPushSourcePosition2.
@@ -232,6 +420,19 @@ public:
 	 */
 	SimpleButtonReceiver* getPushSourceButton( const char* sComponentName ) throw();
 
+	/**
+	 * Gets a pointer to the batch interface of an ApplicationPushSourcePose, which sends
+	 * an array of poses in one call. The poses are sent in array order with their own
+	 * timestamps. The returned object will be deleted by Ubitrack.
+	 *
+	 * @param sComponentName name of the ApplicationPushSourcePose component
+	 * @return NULL if component not found
+	 */
+	SimplePoseBatchReceiver* getPushSourcePoseBatch( const char* sComponentName ) throw();
+	SimplePosition2DBatchReceiver* getPushSourcePosition2DBatch( const char* sComponentName ) throw();
+	SimplePosition3DBatchReceiver* getPushSourcePosition3DBatch( const char* sComponentName ) throw();
+	SimpleButtonBatchReceiver* getPushSourceButtonBatch( const char* sComponentName ) throw();
+
 	/**
 	 * Gets a pointer to a SimpleStringReceiver interface on an ApplicationPushSource.
 	 * The returned object will be deleted by Ubitrack.
@@ -241,14 +442,40 @@ public:
 	 */
 	SimpleStringReceiver* getPushSourceString( const char* sComponentName ) throw();
 
+	/**
+	 * Gets a pointer to a SimpleBinaryReceiver interface on an ApplicationPushSource.
+	 * The returned object will be deleted by Ubitrack.
+	 *
+	 * @param sComponentName name of the ApplicationPushSource component
+	 * @return NULL if component not found
+	 */
+	SimpleBinaryReceiver* getPushSourceBinary( const char* sComponentName ) throw();
+
+	/**
+	 * Retrieves the decoding and admission statistics of an ApplicationPushSource: the
+	 * number of string and binary events dropped because of parse errors, and the number of
+	 * events admitted, coalesced and dropped by the admission policy.
+	 *
+	 * @param sComponentName name of the ApplicationPushSource
+	 * @param stats statistics are returned in this object on success
+	 * @return true if successful
+	 */
+	bool getPushSourceStats( const char* sComponentName, SimplePushSourceStats& stats ) throw();
+
 
 	SimplePositionList3DReceiver* getPushSourcePositionList3D( const char* sComponentName ) throw();
 	/**
 	 * Gets a pointer to a SimpleApplicationPullSinkPose object which can be used for
 	 * retrieving pose data via its getSimplePose() method.
 	 *
-	 * The returned object will NOT be freed by Ubitrack and has to be deleted by the caller. 
-	 * It will render useless, however, when stopping the dataflow.
+	 * The returned object is owned by the facade and must not be deleted. Requesting the
+	 * same component again returns the same object, so it is cheap to call this every frame.
+	 * The object stays valid when a dataflow is loaded or cleared and then refers to the
+	 * component with the same name in the new dataflow. This also holds for the other
+	 * getPullSink* methods.
+	 *
+	 * The ApplicationBufferedPullSink components derive from ApplicationPullSink, so
+	 * getSimplePullSinkPose and getPullSinkPosition3D also accept them.
 	 *
 	 * @param sComponentName name of the ApplicationPullSinkPose component for
 	 * which a proxy shall be returned
@@ -267,6 +494,38 @@ public:
 	SimpleApplicationPullSinkPositionList3D * getPullSinkPosition3DList( const char* sComponentName ) throw();
 	SimpleApplicationPullSinkErrorPositionList3D * getPullSinkErrorPosition3DList( const char* sComponentName ) throw();
 
+	/**
+	 * Returns a handle for an ApplicationPullSinkPose or ApplicationPullSinkErrorPose to be
+	 * used with pullSnapshot. Requesting the same sink twice returns the same handle.
+	 * Handles stay valid when a dataflow is reloaded and refer to the sink with the same name.
+	 *
+	 * @param sComponentName name of the pull sink
+	 * @return the handle or -1 if there is no pose pull sink with this name
+	 */
+	int getPullSinkHandle( const char* sComponentName ) throw();
+
+	/**
+	 * Pulls the poses of several sinks for the same timestamp in one call.
+	 * ErrorPose sinks deliver their pose without covariance. A sink listed more than once
+	 * is only pulled once. A failing sink does not affect the other sinks.
+	 *
+	 * @param pHandles array of \p nCount handles returned by getPullSinkHandle
+	 * @param nCount number of sinks
+	 * @param timestamp the timestamp to pull
+	 * @param pPoses array of \p nCount poses receiving the results
+	 * @param pStatus array of \p nCount entries receiving the status of each sink. The pose is set for PULL_OK and PULL_STALE.
+	 * @return number of sinks with status PULL_OK or -1 on error
+	 */
+	int pullSnapshot( const int* pHandles, unsigned int nCount, unsigned long long int timestamp,
+		SimplePose* pPoses, SimplePullStatus* pStatus ) throw();
+
+	/**
+	 * Like pullSnapshot, but returns the poses with covariance. All handles must refer to
+	 * ApplicationPullSinkErrorPose components, other sinks get the status PULL_ERROR.
+	 */
+	int pullErrorSnapshot( const int* pHandles, unsigned int nCount, unsigned long long int timestamp,
+		SimpleErrorPose* pPoses, SimplePullStatus* pStatus ) throw();
+
 	/**
 	 * Get notifications when new dataflow components are created or deleted
 	 *
@@ -279,6 +538,16 @@ public:
 	 */
 	void removeDataflowObserver() throw();
 	
+	/**
+	 * Sets the sampling rate of per-event tracing. Tracing is only compiled into debug
+	 * builds; in release builds the setting has no effect.
+	 *
+	 * @param sCategory "PushSink", "PushSource", "PullSink", "Converter" or 0 for all categories
+	 * @param nEvery record every n-th event, 1 records all events, 0 disables tracing
+	 * @return false if the category is unknown
+	 */
+	bool setTraceSampling( const char* sCategory, unsigned int nEvery ) throw();
+	
 	/** returns the description of the last error or 0 if there was no error so far. */	
 	const char* getLastError() throw();
 	
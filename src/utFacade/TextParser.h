@@ -0,0 +1,664 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Fast parser for the text representation of measurements written by
+ * \c Util::SimpleStringOArchive, used by \c ApplicationPushSource::receiveString.
+ *
+ * The archive text is a sequence of whitespace separated tokens. Besides the timestamp
+ * and the values, it contains bookkeeping tokens of the serialization library. Instead of
+ * hardcoding them, the parser learns the layout of each measurement type once by
+ * writing probe measurements with distinct values through the archive and locating the
+ * values in the resulting text. Texts that do not match the learned layout exactly are
+ * rejected, so the caller can fall back to the archive.
+ *
+ * Parsing does not allocate apart from the measurement itself and does not depend on
+ * the locale. Numbers with up to 15 significant digits and a small exponent are converted
+ * directly, longer numbers are passed to \c strtod from a stack buffer.
+ */
+
+#ifndef __UBITRACK_FACADE_TEXTPARSER_H_INCLUDED__
+#define __UBITRACK_FACADE_TEXTPARSER_H_INCLUDED__
+
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <string>
+#include <vector>
+#include <boost/thread/once.hpp>
+#include <boost/shared_ptr.hpp>
+#include <utMeasurement/Measurement.h>
+#include <utUtil/SimpleStringOArchive.h>
+
+namespace Ubitrack { namespace Facade {
+
+/** a token of a text, not terminated */
+struct TextToken
+{
+	const char* pBegin;
+	const char* pEnd;
+};
+
+/** splits a text into whitespace separated tokens */
+class TextTokenizer
+{
+public:
+	TextTokenizer( const char* s )
+		: m_p( s )
+	{}
+
+	/** @return false at the end of the text */
+	bool next( TextToken& token )
+	{
+		while ( *m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r' )
+			m_p++;
+		if ( !*m_p )
+			return false;
+
+		token.pBegin = m_p;
+		while ( *m_p && *m_p != ' ' && *m_p != '\t' && *m_p != '\n' && *m_p != '\r' )
+			m_p++;
+		token.pEnd = m_p;
+		return true;
+	}
+
+	/** true if only whitespace is left */
+	bool atEnd()
+	{
+		TextToken token;
+		return !next( token );
+	}
+
+protected:
+	const char* m_p;
+};
+
+/** parses an unsigned decimal integer */
+inline bool parseTextUInt64( const TextToken& token, unsigned long long& value )
+{
+	if ( token.pBegin == token.pEnd )
+		return false;
+
+	unsigned long long v = 0;
+	for ( const char* p = token.pBegin; p != token.pEnd; p++ )
+	{
+		if ( *p < '0' || *p > '9' )
+			return false;
+		unsigned int d = *p - '0';
+		if ( v > ( ~0ULL - d ) / 10 )
+			return false;
+		v = v * 10 + d;
+	}
+	value = v;
+	return true;
+}
+
+/** converts numbers the fast path cannot handle exactly with strtod, replacing the decimal point of the current locale */
+inline bool parseTextDoubleSlow( const TextToken& token, double& value )
+{
+	char buffer[ 64 ];
+	std::size_t n = token.pEnd - token.pBegin;
+	if ( n >= sizeof( buffer ) )
+		return false;
+
+	const char cPoint = *localeconv()->decimal_point;
+	for ( std::size_t i = 0; i < n; i++ )
+		buffer[ i ] = token.pBegin[ i ] == '.' ? cPoint : token.pBegin[ i ];
+	buffer[ n ] = 0;
+
+	char* pEnd;
+	value = strtod( buffer, &pEnd );
+	return n && pEnd == buffer + n;
+}
+
+/**
+ * Parses a floating point number in the C locale.
+ * Numbers whose mantissa and power of ten are exactly representable are converted
+ * with a single correctly rounded operation, all others with \c parseTextDoubleSlow.
+ */
+inline bool parseTextDouble( const TextToken& token, double& value )
+{
+	static const double s_powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char* p = token.pBegin;
+	bool bNegative = false;
+	if ( p != token.pEnd && ( *p == '-' || *p == '+' ) )
+		bNegative = *p++ == '-';
+
+	unsigned long long nMantissa = 0;
+	int nSignificant = 0;
+	int nExponent = 0;
+	bool bDigits = false;
+	for ( ; p != token.pEnd && *p >= '0' && *p <= '9'; p++ )
+	{
+		bDigits = true;
+		if ( nSignificant < 19 )
+		{
+			nMantissa = nMantissa * 10 + ( *p - '0' );
+			if ( nMantissa )
+				nSignificant++;
+		}
+		else
+			nExponent++;
+	}
+	if ( p != token.pEnd && *p == '.' )
+		for ( p++; p != token.pEnd && *p >= '0' && *p <= '9'; p++ )
+		{
+			bDigits = true;
+			if ( nSignificant < 19 )
+			{
+				nMantissa = nMantissa * 10 + ( *p - '0' );
+				if ( nMantissa )
+					nSignificant++;
+				nExponent--;
+			}
+		}
+
+	// inf, nan and other spellings
+	if ( !bDigits )
+		return parseTextDoubleSlow( token, value );
+
+	if ( p != token.pEnd && ( *p == 'e' || *p == 'E' ) )
+	{
+		p++;
+		bool bNegativeExponent = false;
+		if ( p != token.pEnd && ( *p == '-' || *p == '+' ) )
+			bNegativeExponent = *p++ == '-';
+		if ( p == token.pEnd )
+			return false;
+		int e = 0;
+		for ( ; p != token.pEnd && *p >= '0' && *p <= '9'; p++ )
+			if ( e < 10000 )
+				e = e * 10 + ( *p - '0' );
+		nExponent += bNegativeExponent ? -e : e;
+	}
+	if ( p != token.pEnd )
+		return false;
+
+	// 15 digits always fit into the 53 bit mantissa of a double
+	if ( nSignificant > 15 || nExponent < -22 || nExponent > 22 )
+		return parseTextDoubleSlow( token, value );
+
+	double v = static_cast< double >( nMantissa );
+	v = nExponent < 0 ? v / s_powers[ -nExponent ] : v * s_powers[ nExponent ];
+	value = bNegative ? -v : v;
+	return true;
+}
+
+
+/**
+ * Describes how the values of a measurement type are read from parsed numbers.
+ * The primary template is used for types the parser does not support.
+ */
+template< class ValueType >
+struct TextValue
+{
+	static const bool s_bSupported = false;
+	static const bool s_bList = false;
+	static const unsigned int s_nFields = 1;
+
+	static bool valid( const double* )
+	{ return false; }
+
+	static ValueType make( const double* )
+	{ return ValueType(); }
+};
+
+template<>
+struct TextValue< Math::Scalar< int > >
+{
+	static const bool s_bSupported = true;
+	static const bool s_bList = false;
+	static const unsigned int s_nFields = 1;
+
+	static bool valid( const double* f )
+	{ return f[ 0 ] >= -2147483648.0 && f[ 0 ] <= 2147483647.0 && f[ 0 ] == static_cast< int >( f[ 0 ] ); }
+
+	static Math::Scalar< int > make( const double* f )
+	{ return Math::Scalar< int >( static_cast< int >( f[ 0 ] ) ); }
+};
+
+/** vectors of \p N doubles */
+template< unsigned int N >
+struct TextVectorValue
+{
+	static const bool s_bSupported = true;
+	static const bool s_bList = false;
+	static const unsigned int s_nFields = N;
+
+	static bool valid( const double* )
+	{ return true; }
+
+	static Math::Vector< double, N > make( const double* f )
+	{
+		Math::Vector< double, N > v;
+		for ( unsigned int i = 0; i < N; i++ )
+			v[ i ] = f[ i ];
+		return v;
+	}
+};
+
+template<>
+struct TextValue< Math::Vector< double, 2 > >
+	: public TextVectorValue< 2 >
+{};
+
+template<>
+struct TextValue< Math::Vector< double, 3 > >
+	: public TextVectorValue< 3 >
+{};
+
+template<>
+struct TextValue< Math::Quaternion >
+{
+	static const bool s_bSupported = true;
+	static const bool s_bList = false;
+	static const unsigned int s_nFields = 4;
+
+	static bool valid( const double* )
+	{ return true; }
+
+	static Math::Quaternion make( const double* f )
+	{ return Math::Quaternion( f[ 0 ], f[ 1 ], f[ 2 ], f[ 3 ] ); }
+};
+
+template<>
+struct TextValue< Math::Pose >
+{
+	static const bool s_bSupported = true;
+	static const bool s_bList = false;
+	static const unsigned int s_nFields = 7;
+
+	static bool valid( const double* )
+	{ return true; }
+
+	static Math::Pose make( const double* f )
+	{ return Math::Pose( TextValue< Math::Quaternion >::make( f ), Math::Vector< double, 3 >( f[ 4 ], f[ 5 ], f[ 6 ] ) ); }
+};
+
+/** lists of the supported values */
+template< class ElementType >
+struct TextValue< std::vector< ElementType > >
+{
+	typedef TextValue< ElementType > Element;
+
+	static const bool s_bSupported = Element::s_bSupported;
+	static const bool s_bList = true;
+	static const unsigned int s_nFields = Element::s_nFields;
+};
+
+
+/** layout of the archive text of a measurement type */
+struct TextLayout
+{
+	/** meaning of a token */
+	struct Slot
+	{
+		enum Role { Literal, Timestamp, Count, Field };
+
+		Role role;
+
+		/** index of the value for \c Field, counted over all elements of the probe while learning */
+		unsigned int nField;
+
+		/** expected text of a \c Literal */
+		std::string sLiteral;
+	};
+	typedef std::vector< Slot > Slots;
+
+	TextLayout()
+		: bValid( false )
+	{}
+
+	/** true if the layout was learned */
+	bool bValid;
+
+	/** all tokens of single values, the tokens up to the end of the first element of non-empty lists */
+	Slots head;
+
+	/** tokens of each further element of a list */
+	Slots element;
+
+	/** tokens after the last element of a list */
+	Slots tail;
+
+	/** all tokens of an empty list */
+	Slots empty;
+};
+
+
+/**
+ * Parser for the archive text of \p EventType.
+ * \c parse returns false for unsupported types and texts that do not match the layout.
+ */
+template< class EventType >
+class TextParser
+{
+public:
+	typedef typename EventType::value_type ValueType;
+	typedef TextValue< ValueType > Value;
+
+	/** true if the type is supported and its layout could be learned */
+	static bool supported()
+	{ return layout().bValid; }
+
+	/**
+	 * Parses a measurement.
+	 * @return false if the text does not match the learned layout
+	 */
+	static bool parse( const char* s, EventType& e )
+	{
+		const TextLayout& l( layout() );
+		if ( !l.bValid || !s )
+			return false;
+		return parseValue( l, s, e, static_cast< ValueType* >( 0 ) );
+	}
+
+protected:
+	/** largest number of values of a single value or list element */
+	static const unsigned int s_nMaxFields = 8;
+
+	static const unsigned long long s_probeTime = 1234567890123456789ULL;
+
+	/** distinct value of field \p k of element \p i of the probes */
+	static double probeField( unsigned int i, unsigned int k )
+	{ return 7340033.0 + 64.0 * i + k; }
+
+	/** the layout, learned on the first call */
+	static const TextLayout& layout()
+	{
+		static boost::once_flag s_once = BOOST_ONCE_INIT;
+		boost::call_once( s_once, &TextParser::learn );
+		return storage();
+	}
+
+	static TextLayout& storage()
+	{
+		static TextLayout s_layout;
+		return s_layout;
+	}
+
+	static void learn()
+	{
+		TextLayout& l( storage() );
+		if ( Value::s_bSupported && Value::s_nFields <= s_nMaxFields )
+		{
+			try
+			{
+				learnLayout( l, static_cast< ValueType* >( 0 ) );
+			}
+			catch ( ... )
+			{
+				l.bValid = false;
+			}
+		}
+	}
+
+	/** reads the slots of a single value */
+	static bool readSlots( TextTokenizer& tokens, const TextLayout::Slots& slots, Measurement::Timestamp& t,
+		unsigned long long& nCount, double* pFields )
+	{
+		TextToken token;
+		for ( TextLayout::Slots::const_iterator it = slots.begin(); it != slots.end(); ++it )
+		{
+			if ( !tokens.next( token ) )
+				return false;
+
+			switch ( it->role )
+			{
+			case TextLayout::Slot::Literal:
+				if ( it->sLiteral.size() != static_cast< std::size_t >( token.pEnd - token.pBegin ) ||
+					memcmp( it->sLiteral.data(), token.pBegin, it->sLiteral.size() ) != 0 )
+					return false;
+				break;
+			case TextLayout::Slot::Timestamp:
+				if ( !parseTextUInt64( token, t ) )
+					return false;
+				break;
+			case TextLayout::Slot::Count:
+				if ( !parseTextUInt64( token, nCount ) )
+					return false;
+				break;
+			case TextLayout::Slot::Field:
+				if ( !parseTextDouble( token, pFields[ it->nField ] ) )
+					return false;
+				break;
+			}
+		}
+		return true;
+	}
+
+	/** parses single values */
+	template< class V >
+	static bool parseValue( const TextLayout& l, const char* s, EventType& e, V* )
+	{
+		TextTokenizer tokens( s );
+		Measurement::Timestamp t( 0 );
+		unsigned long long nCount( 0 );
+		double fields[ s_nMaxFields ];
+		if ( !readSlots( tokens, l.head, t, nCount, fields ) || !tokens.atEnd() || !Value::valid( fields ) )
+			return false;
+
+		e = EventType( t, Value::make( fields ) );
+		return true;
+	}
+
+	/** parses lists */
+	template< class ElementType >
+	static bool parseValue( const TextLayout& l, const char* s, EventType& e, std::vector< ElementType >* )
+	{
+		typedef TextValue< ElementType > Element;
+
+		TextTokenizer tokens( s );
+		Measurement::Timestamp t( 0 );
+		unsigned long long nCount( 0 );
+		double fields[ s_nMaxFields ];
+		if ( !readSlots( tokens, l.head, t, nCount, fields ) )
+		{
+			// the head of a non-empty list is longer than an empty list
+			TextTokenizer emptyTokens( s );
+			if ( !readSlots( emptyTokens, l.empty, t, nCount, fields ) || nCount != 0 || !emptyTokens.atEnd() )
+				return false;
+			e = EventType( t, boost::shared_ptr< std::vector< ElementType > >( new std::vector< ElementType > ) );
+			return true;
+		}
+		if ( nCount == 0 || !Element::valid( fields ) )
+			return false;
+
+		boost::shared_ptr< std::vector< ElementType > > pList( new std::vector< ElementType > );
+		pList->reserve( nCount < 1024 ? static_cast< std::size_t >( nCount ) : 1024 );
+		pList->push_back( Element::make( fields ) );
+		for ( unsigned long long i = 1; i < nCount; i++ )
+		{
+			if ( !readSlots( tokens, l.element, t, nCount, fields ) || !Element::valid( fields ) )
+				return false;
+			pList->push_back( Element::make( fields ) );
+		}
+		if ( !readSlots( tokens, l.tail, t, nCount, fields ) || !tokens.atEnd() )
+			return false;
+
+		e = EventType( t, pList );
+		return true;
+	}
+
+	/** writes a measurement through the archive and classifies its tokens */
+	static TextLayout::Slots probe( const EventType& e, unsigned int nElements )
+	{
+		Util::SimpleStringOArchive ar;
+		ar << e;
+		const std::string s( ar.str() );
+
+		TextLayout::Slots slots;
+		TextTokenizer tokens( s.c_str() );
+		TextToken token;
+		while ( tokens.next( token ) )
+		{
+			TextLayout::Slot slot;
+			slot.role = TextLayout::Slot::Literal;
+			slot.nField = 0;
+			slot.sLiteral.assign( token.pBegin, token.pEnd );
+
+			unsigned long long n;
+			double v;
+			if ( parseTextUInt64( token, n ) && n == s_probeTime )
+				slot.role = TextLayout::Slot::Timestamp;
+			else if ( parseTextDouble( token, v ) )
+				for ( unsigned int i = 0; i < nElements * Value::s_nFields; i++ )
+					if ( v == probeField( i / Value::s_nFields, i % Value::s_nFields ) )
+					{
+						slot.role = TextLayout::Slot::Field;
+						slot.nField = i;
+					}
+			slots.push_back( slot );
+		}
+
+		// every value must appear exactly once
+		std::vector< int > found( nElements * Value::s_nFields + 1, 0 );
+		for ( std::size_t i = 0; i < slots.size(); i++ )
+			if ( slots[ i ].role == TextLayout::Slot::Timestamp )
+				found.back()++;
+			else if ( slots[ i ].role == TextLayout::Slot::Field )
+				found[ slots[ i ].nField ]++;
+		for ( std::size_t i = 0; i < found.size(); i++ )
+			if ( found[ i ] != 1 )
+				UBITRACK_THROW( "Cannot locate the values in the archive text" );
+		return slots;
+	}
+
+	/** fills probe values into a field array */
+	static void probeFields( unsigned int nElement, double* pFields )
+	{
+		for ( unsigned int k = 0; k < Value::s_nFields; k++ )
+			pFields[ k ] = probeField( nElement, k );
+	}
+
+	template< class V >
+	static void learnLayout( TextLayout& l, V* )
+	{
+		double fields[ s_nMaxFields ];
+		probeFields( 0, fields );
+		l.head = probe( EventType( s_probeTime, Value::make( fields ) ), 1 );
+		l.bValid = true;
+	}
+
+	/** first token of element \p nElement */
+	static std::size_t elementStart( const TextLayout::Slots& slots, unsigned int nElement )
+	{
+		for ( std::size_t i = 0; i < slots.size(); i++ )
+			if ( slots[ i ].role == TextLayout::Slot::Field && slots[ i ].nField / Value::s_nFields == nElement )
+				return i;
+		return slots.size();
+	}
+
+	/** true if both slot lists have the same shape, with field indices shifted by \p nFieldOffset */
+	static bool sameSlots( const TextLayout::Slots& a, std::size_t nBeginA, const TextLayout::Slots& b, std::size_t nBeginB,
+		std::size_t nLength, unsigned int nFieldOffset )
+	{
+		if ( nBeginA + nLength > a.size() || nBeginB + nLength > b.size() )
+			return false;
+		for ( std::size_t i = 0; i < nLength; i++ )
+		{
+			const TextLayout::Slot& x( a[ nBeginA + i ] );
+			const TextLayout::Slot& y( b[ nBeginB + i ] );
+			if ( x.role != y.role || ( x.role == TextLayout::Slot::Field && x.nField + nFieldOffset != y.nField ) ||
+				( x.role == TextLayout::Slot::Literal && x.sLiteral != y.sLiteral ) )
+				return false;
+		}
+		return true;
+	}
+
+	/** builds a list probe with \p nElements elements */
+	template< class ElementType >
+	static EventType listProbe( unsigned int nElements )
+	{
+		double fields[ s_nMaxFields ];
+		std::vector< ElementType > list;
+		for ( unsigned int i = 0; i < nElements; i++ )
+		{
+			probeFields( i, fields );
+			list.push_back( TextValue< ElementType >::make( fields ) );
+		}
+		return EventType( s_probeTime, list );
+	}
+
+	/**
+	 * Learns the layout of lists from probes with 0, 2 and 3 elements. The probe with three
+	 * elements is split into the head up to the second element, the second element and the
+	 * rest, the others must match this split.
+	 */
+	template< class ElementType >
+	static void learnLayout( TextLayout& l, std::vector< ElementType >* )
+	{
+		TextLayout::Slots p0( probe( listProbe< ElementType >( 0 ), 0 ) );
+		TextLayout::Slots p2( probe( listProbe< ElementType >( 2 ), 2 ) );
+		TextLayout::Slots p3( probe( listProbe< ElementType >( 3 ), 3 ) );
+
+		const std::size_t a0( elementStart( p3, 0 ) );
+		const std::size_t a1( elementStart( p3, 1 ) );
+		const std::size_t a2( elementStart( p3, 2 ) );
+		if ( !( a0 < a1 && a1 < a2 && a2 < p3.size() ) )
+			UBITRACK_THROW( "Unexpected list layout in the archive text" );
+		const std::size_t nStride( a2 - a1 );
+
+		// the count is the only token before the first element that differs between the probes
+		std::size_t nCountSlot( a0 );
+		for ( std::size_t i = 0; i < a0 && i < p2.size(); i++ )
+			if ( p2[ i ].role == TextLayout::Slot::Literal && p2[ i ].sLiteral == "2" &&
+				p3[ i ].role == TextLayout::Slot::Literal && p3[ i ].sLiteral == "3" )
+			{
+				nCountSlot = i;
+				break;
+			}
+		if ( nCountSlot == a0 || nCountSlot >= p0.size() || p0[ nCountSlot ].sLiteral != "0" )
+			UBITRACK_THROW( "Cannot locate the element count in the archive text" );
+		p0[ nCountSlot ].role = TextLayout::Slot::Count;
+		p2[ nCountSlot ].role = TextLayout::Slot::Count;
+		p3[ nCountSlot ].role = TextLayout::Slot::Count;
+
+		// the third element looks like the second, and the probe with two elements is the same without it
+		const std::size_t nTail( p3.size() - a2 - nStride );
+		if ( !sameSlots( p3, a1, p3, a2, nStride, Value::s_nFields ) || p2.size() != a1 + nStride + nTail ||
+			!sameSlots( p3, 0, p2, 0, a1 + nStride, 0 ) || !sameSlots( p3, a2 + nStride, p2, a1 + nStride, nTail, 0 ) )
+			UBITRACK_THROW( "Unexpected list layout in the archive text" );
+
+		// the head holds exactly the values of the first element
+		for ( std::size_t i = 0; i < p3.size(); i++ )
+			if ( p3[ i ].role == TextLayout::Slot::Field && ( p3[ i ].nField < Value::s_nFields ) != ( i < a1 ) )
+				UBITRACK_THROW( "Unexpected list layout in the archive text" );
+
+		l.head.assign( p3.begin(), p3.begin() + a1 );
+		l.element.assign( p3.begin() + a1, p3.begin() + a2 );
+		for ( std::size_t i = 0; i < l.element.size(); i++ )
+			l.element[ i ].nField -= l.element[ i ].role == TextLayout::Slot::Field ? Value::s_nFields : 0;
+		l.tail.assign( p3.begin() + a2 + nStride, p3.end() );
+		l.empty = p0;
+		l.bValid = true;
+	}
+};
+
+} } // namespace Ubitrack::Facade
+
+#endif // __UBITRACK_FACADE_TEXTPARSER_H_INCLUDED__
@@ -0,0 +1,260 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Implements the trace buffer of the facade.
+ */
+
+#include <string.h>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <log4cpp/Category.hh>
+
+#include "Trace.h"
+
+// get a logger
+static log4cpp::Category& traceLogger( log4cpp::Category::getInstance( "Ubitrack.Facade.Trace" ) );
+
+namespace Ubitrack { namespace Facade { namespace Trace {
+
+namespace {
+
+const char* const g_categoryNames[ CategoryCount ] = { "PushSink", "PushSource", "PullSink", "Converter" };
+
+/** a single trace record. The sequence number tells whether the slot is free or holds a complete record. */
+struct TraceRecord
+{
+	boost::atomic< std::size_t > sequence;
+	Category category;
+	const char* sWhat;
+	char sName[ 48 ];
+	unsigned long long timestamp;
+	unsigned int nValues;
+	double values[ 3 ];
+};
+
+/**
+ * Bounded multi-producer, single-consumer ring of trace records.
+ * Producers claim a slot with a single compare-and-swap and never block; the records
+ * are formatted and logged by a background thread that is started with the first record.
+ */
+class TraceBuffer
+{
+public:
+	/** number of records, must be a power of two */
+	static const std::size_t s_nCapacity = 4096;
+
+	TraceBuffer()
+		: m_nDropped( 0 )
+		, m_nEnqueue( 0 )
+		, m_nDequeue( 0 )
+		, m_bStarted( false )
+		, m_bStop( false )
+	{
+		for ( std::size_t i = 0; i < s_nCapacity; i++ )
+			m_records[ i ].sequence.store( i, boost::memory_order_relaxed );
+
+		for ( int i = 0; i < CategoryCount; i++ )
+		{
+			m_sampling[ i ].store( 1, boost::memory_order_relaxed );
+			m_counters[ i ].store( 0, boost::memory_order_relaxed );
+		}
+	}
+
+	~TraceBuffer()
+	{
+		if ( m_pThread )
+		{
+			// the flusher checks the flag at least every 50 ms, and must not outlive the ring it reads
+			m_bStop.store( true );
+			m_pThread->join();
+		}
+	}
+
+	bool push( Category category, const char* sWhat, const char* sName, unsigned long long timestamp,
+		unsigned int nValues, double v0, double v1, double v2 )
+	{
+		if ( !m_bStarted.load( boost::memory_order_acquire ) )
+			startFlusher();
+
+		std::size_t pos = m_nEnqueue.load( boost::memory_order_relaxed );
+		TraceRecord* pRecord;
+		while ( true )
+		{
+			pRecord = &m_records[ pos & ( s_nCapacity - 1 ) ];
+			std::size_t seq = pRecord->sequence.load( boost::memory_order_acquire );
+			std::ptrdiff_t diff = static_cast< std::ptrdiff_t >( seq ) - static_cast< std::ptrdiff_t >( pos );
+
+			if ( diff == 0 )
+			{
+				if ( m_nEnqueue.compare_exchange_weak( pos, pos + 1, boost::memory_order_relaxed ) )
+					break;
+			}
+			else if ( diff < 0 )
+			{
+				// buffer full
+				m_nDropped.fetch_add( 1, boost::memory_order_relaxed );
+				return false;
+			}
+			else
+				pos = m_nEnqueue.load( boost::memory_order_relaxed );
+		}
+
+		pRecord->category = category;
+		pRecord->sWhat = sWhat;
+		if ( sName )
+		{
+			strncpy( pRecord->sName, sName, sizeof( pRecord->sName ) - 1 );
+			pRecord->sName[ sizeof( pRecord->sName ) - 1 ] = 0;
+		}
+		else
+			pRecord->sName[ 0 ] = 0;
+		pRecord->timestamp = timestamp;
+		pRecord->nValues = nValues > 3 ? 3 : nValues;
+		pRecord->values[ 0 ] = v0;
+		pRecord->values[ 1 ] = v1;
+		pRecord->values[ 2 ] = v2;
+
+		pRecord->sequence.store( pos + 1, boost::memory_order_release );
+		return true;
+	}
+
+	boost::atomic< unsigned int > m_sampling[ CategoryCount ];
+	boost::atomic< unsigned long > m_counters[ CategoryCount ];
+	boost::atomic< unsigned long long > m_nDropped;
+
+protected:
+	void startFlusher()
+	{
+		boost::mutex::scoped_lock lock( m_startMutex );
+		if ( m_pThread )
+			return;
+		m_pThread.reset( new boost::thread( boost::bind( &TraceBuffer::flusherThread, this ) ) );
+		m_bStarted.store( true, boost::memory_order_release );
+	}
+
+	void flusherThread()
+	{
+		while ( !m_bStop.load() )
+		{
+			if ( flush() == 0 )
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+		}
+		flush();
+	}
+
+	/** logs all complete records, only called by the flusher thread */
+	std::size_t flush()
+	{
+		std::size_t nFlushed = 0;
+		while ( true )
+		{
+			TraceRecord& record = m_records[ m_nDequeue & ( s_nCapacity - 1 ) ];
+			if ( record.sequence.load( boost::memory_order_acquire ) != m_nDequeue + 1 )
+				break;
+
+			std::ostringstream s;
+			s << g_categoryNames[ record.category ] << ": " << record.sWhat;
+			if ( record.sName[ 0 ] )
+				s << " " << record.sName;
+			s << " t=" << record.timestamp;
+			for ( unsigned int i = 0; i < record.nValues; i++ )
+				s << ( i == 0 ? " [" : " " ) << record.values[ i ];
+			if ( record.nValues )
+				s << "]";
+
+			record.sequence.store( m_nDequeue + s_nCapacity, boost::memory_order_release );
+			m_nDequeue++;
+			nFlushed++;
+
+			LOG4CPP_INFO( traceLogger, s.str() );
+		}
+		return nFlushed;
+	}
+
+	TraceRecord m_records[ s_nCapacity ];
+	boost::atomic< std::size_t > m_nEnqueue;
+	std::size_t m_nDequeue;
+	boost::atomic< bool > m_bStarted;
+	boost::atomic< bool > m_bStop;
+	boost::mutex m_startMutex;
+	boost::scoped_ptr< boost::thread > m_pThread;
+};
+
+TraceBuffer g_traceBuffer;
+
+} // anonymous namespace
+
+
+void setSampling( Category category, unsigned int nEvery )
+{
+	if ( category < 0 || category >= CategoryCount )
+		return;
+	g_traceBuffer.m_sampling[ category ].store( nEvery, boost::memory_order_relaxed );
+}
+
+unsigned int getSampling( Category category )
+{
+	if ( category < 0 || category >= CategoryCount )
+		return 0;
+	return g_traceBuffer.m_sampling[ category ].load( boost::memory_order_relaxed );
+}
+
+bool categoryFromName( const char* sName, Category& category )
+{
+	if ( !sName )
+		return false;
+	for ( int i = 0; i < CategoryCount; i++ )
+		if ( strcmp( sName, g_categoryNames[ i ] ) == 0 )
+		{
+			category = static_cast< Category >( i );
+			return true;
+		}
+	return false;
+}
+
+bool sample( Category category )
+{
+	unsigned int nEvery = g_traceBuffer.m_sampling[ category ].load( boost::memory_order_relaxed );
+	if ( nEvery <= 1 )
+		return nEvery == 1;
+	return g_traceBuffer.m_counters[ category ].fetch_add( 1, boost::memory_order_relaxed ) % nEvery == 0;
+}
+
+void record( Category category, const char* sWhat, const char* sName, unsigned long long timestamp,
+	unsigned int nValues, double v0, double v1, double v2 )
+{
+	g_traceBuffer.push( category, sWhat, sName, timestamp, nValues, v0, v1, v2 );
+}
+
+unsigned long long droppedRecords()
+{
+	return g_traceBuffer.m_nDropped.load( boost::memory_order_relaxed );
+}
+
+} } } // namespace Ubitrack::Facade::Trace
@@ -0,0 +1,121 @@
+/*
+ * Ubitrack - Library for Ubiquitous Tracking
+ * Copyright 2006, Technische Universitaet Muenchen, and individual
+ * contributors as indicated by the @authors tag. See the
+ * copyright.txt in the distribution for a full listing of individual
+ * contributors.
+ *
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this software; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA, or see the FSF site: http://www.fsf.org.
+ */
+
+/**
+ * @ingroup api
+ * @file
+ * Lightweight tracing of per-event activity in the facade and the application components.
+ *
+ * Trace records are written into a preallocated ring buffer and formatted by a
+ * background thread that passes them to the log4cpp category "Ubitrack.Facade.Trace".
+ * Each category can be sampled at runtime, so that only every n-th event is recorded.
+ *
+ * The UTFACADE_TRACE* macros compile to nothing (without evaluating their arguments)
+ * unless \c UTFACADE_TRACING is defined, which is the case for debug builds unless
+ * \c UTFACADE_NO_TRACING is set.
+ */
+
+#ifndef __UBITRACK_FACADE_TRACE_H_INCLUDED__
+#define __UBITRACK_FACADE_TRACE_H_INCLUDED__
+
+#include <utFacade/utFacade.h>
+
+#if !defined( NDEBUG ) && !defined( UTFACADE_NO_TRACING ) && !defined( UTFACADE_TRACING )
+#	define UTFACADE_TRACING
+#endif
+
+namespace Ubitrack { namespace Facade { namespace Trace {
+
+/** trace categories that can be sampled independently */
+enum Category
+{
+	PushSink = 0,
+	PushSource,
+	PullSink,
+	Converter,
+	CategoryCount
+};
+
+/**
+ * Sets the sampling rate of a category.
+ * @param category the trace category
+ * @param nEvery record every n-th event, 1 records all events, 0 disables the category
+ */
+UTFACADE_EXPORT void setSampling( Category category, unsigned int nEvery );
+
+/** returns the sampling rate of a category */
+UTFACADE_EXPORT unsigned int getSampling( Category category );
+
+/**
+ * Looks up a category by name ("PushSink", "PushSource", "PullSink", "Converter").
+ * @return false if the name is unknown
+ */
+UTFACADE_EXPORT bool categoryFromName( const char* sName, Category& category );
+
+/** returns true if the current event of the category should be recorded */
+UTFACADE_EXPORT bool sample( Category category );
+
+/**
+ * Writes a record to the trace buffer. Never blocks; if the buffer is full, the record is dropped.
+ * @param category the trace category
+ * @param sWhat static string describing the event. Only the pointer is stored, so it must be a literal.
+ * @param sName name of the component or sink, copied (and truncated) into the record. May be NULL.
+ * @param timestamp timestamp of the event
+ * @param nValues number of values (0 to 3) following
+ */
+UTFACADE_EXPORT void record( Category category, const char* sWhat, const char* sName, unsigned long long timestamp,
+	unsigned int nValues = 0, double v0 = 0.0, double v1 = 0.0, double v2 = 0.0 );
+
+/** returns the number of records dropped because the buffer was full */
+UTFACADE_EXPORT unsigned long long droppedRecords();
+
+} } } // namespace Ubitrack::Facade::Trace
+
+#ifdef UTFACADE_TRACING
+
+#define UTFACADE_TRACE( category, what, name, timestamp ) \
+	do { if ( ::Ubitrack::Facade::Trace::sample( ::Ubitrack::Facade::Trace::category ) ) \
+		::Ubitrack::Facade::Trace::record( ::Ubitrack::Facade::Trace::category, what, name, timestamp ); } while ( false )
+
+#define UTFACADE_TRACE1( category, what, name, timestamp, v0 ) \
+	do { if ( ::Ubitrack::Facade::Trace::sample( ::Ubitrack::Facade::Trace::category ) ) \
+		::Ubitrack::Facade::Trace::record( ::Ubitrack::Facade::Trace::category, what, name, timestamp, 1, v0 ); } while ( false )
+
+#define UTFACADE_TRACE2( category, what, name, timestamp, v0, v1 ) \
+	do { if ( ::Ubitrack::Facade::Trace::sample( ::Ubitrack::Facade::Trace::category ) ) \
+		::Ubitrack::Facade::Trace::record( ::Ubitrack::Facade::Trace::category, what, name, timestamp, 2, v0, v1 ); } while ( false )
+
+#define UTFACADE_TRACE3( category, what, name, timestamp, v0, v1, v2 ) \
+	do { if ( ::Ubitrack::Facade::Trace::sample( ::Ubitrack::Facade::Trace::category ) ) \
+		::Ubitrack::Facade::Trace::record( ::Ubitrack::Facade::Trace::category, what, name, timestamp, 3, v0, v1, v2 ); } while ( false )
+
+#else // UTFACADE_TRACING
+
+#define UTFACADE_TRACE( category, what, name, timestamp ) do {} while ( false )
+#define UTFACADE_TRACE1( category, what, name, timestamp, v0 ) do {} while ( false )
+#define UTFACADE_TRACE2( category, what, name, timestamp, v0, v1 ) do {} while ( false )
+#define UTFACADE_TRACE3( category, what, name, timestamp, v0, v1, v2 ) do {} while ( false )
+
+#endif // UTFACADE_TRACING
+
+#endif // __UBITRACK_FACADE_TRACE_H_INCLUDED__